@@ -18,26 +18,44 @@
 */
 
 #include "app.h"
+#include "clock.h"
 #include "config.h"
 #include "load_config.h"
 #include "fetcher/fetcher.h"
 #include "renderer/renderer.h"
+#include "renderer/offline_render.h"
 #include "presenter/presenter.h"
+#include <chrono>
 #include <memory>
 
 namespace dmhm {
 
 struct ApplicationPrivate {
+    std::chrono::steady_clock::time_point start_time;
+    std::unique_ptr<Clock> clock;
     std::unique_ptr<Fetcher> fetcher;
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Presenter> presenter;
+    std::unique_ptr<OfflineRenderer> offline_renderer;
 };
 
 Application::Application() {
+    p->start_time = std::chrono::steady_clock::now();
     load_config(config::config_filename);
+    if(config::clock_step != 0)
+        p->clock.reset(new Clock(p->start_time));
+    else
+        p->clock.reset(new Clock);
+    if(*config::offline_timeline != '\0') {
+        /* No window and no input, the recorded timeline goes to video_output */
+        p->offline_renderer.reset(new OfflineRenderer(this));
+        return;
+    }
     p->fetcher.reset(new Fetcher(this));
-    p->presenter.reset(new Presenter(this));
+    /* Renderer loads fonts in background while presenter creates the window */
     p->renderer.reset(new Renderer(this));
+    p->presenter.reset(new Presenter(this));
+    p->renderer->wait_ready();
 }
 
 Application::~Application() {
@@ -56,7 +74,17 @@ struct BasePresenter *Application::get_presenter() const {
     return reinterpret_cast<struct BasePresenter *>(p->presenter.get());
 }
 
+std::chrono::steady_clock::time_point Application::get_start_time() const {
+    return p->start_time;
+}
+
+Clock *Application::get_clock() const {
+    return p->clock.get();
+}
+
 int Application::run() {
+    if(p->offline_renderer)
+        return p->offline_renderer->run();
     p->fetcher->run_thread();
     return p->presenter->run_loop();
 }
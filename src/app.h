@@ -19,6 +19,7 @@
 
 #pragma once
 #include "utils.h"
+#include <chrono>
 
 namespace dmhm {
 
@@ -29,6 +30,8 @@ public:
     Application();
     ~Application();
     int run();
+    std::chrono::steady_clock::time_point get_start_time() const;
+    class Clock *get_clock() const;
     struct BaseFetcher *get_fetcher() const;
     struct BaseRenderer *get_renderer() const;
     struct BasePresenter *get_presenter() const;
@@ -0,0 +1,65 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "clock.h"
+#include "utils.h"
+#include <atomic>
+#include <chrono>
+
+namespace dmhm {
+
+struct ClockPrivate {
+    bool is_virtual = false;
+    std::atomic<std::chrono::steady_clock::rep> virtual_time = {0};
+};
+
+Clock::Clock() {
+}
+
+Clock::Clock(std::chrono::steady_clock::time_point start) {
+    p->is_virtual = true;
+    p->virtual_time = start.time_since_epoch().count();
+}
+
+Clock::~Clock() {
+}
+
+bool Clock::is_virtual() const {
+    return p->is_virtual;
+}
+
+std::chrono::steady_clock::time_point Clock::now() const {
+    if(!p->is_virtual)
+        return std::chrono::steady_clock::now();
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(p->virtual_time.load()));
+}
+
+void Clock::advance(std::chrono::steady_clock::duration step) {
+    dmhm_assert(p->is_virtual);
+    dmhm_assert(step.count() >= 0);
+    p->virtual_time += step.count();
+}
+
+void Clock::set_time(std::chrono::steady_clock::time_point time) {
+    dmhm_assert(p->is_virtual);
+    dmhm_assert(time.time_since_epoch().count() >= p->virtual_time.load());
+    p->virtual_time = time.time_since_epoch().count();
+}
+
+}
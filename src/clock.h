@@ -0,0 +1,49 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+#include "utils.h"
+#include <chrono>
+
+namespace dmhm {
+
+/* Where every timestamp and every animation takes its time from.
+   A real clock follows std::chrono::steady_clock. A virtual clock stands still
+   until it is stepped, so the same input paints the same frames however long
+   they take, and hours of timeline can go by in seconds */
+class Clock {
+
+public:
+
+    Clock();
+    explicit Clock(std::chrono::steady_clock::time_point start);
+    ~Clock();
+    bool is_virtual() const;
+    std::chrono::steady_clock::time_point now() const;
+    /* Only for a virtual clock, which never goes backwards. Safe against now() on other threads */
+    void advance(std::chrono::steady_clock::duration step);
+    void set_time(std::chrono::steady_clock::time_point time);
+
+private:
+
+    proxy_ptr<struct ClockPrivate> p;
+
+};
+
+}
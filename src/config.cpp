@@ -19,6 +19,8 @@
 
 #include "config.h"
 #include <cstdint>
+#include <string>
+#include <vector>
 
 namespace dmhm {
 namespace config {
@@ -30,14 +32,41 @@ uint32_t extra_line_height = 8;
 
 const char *font_file = "font.ttf";
 uint32_t font_file_index = 0;
+std::vector<std::string> fallback_font_files;
 double font_size = 24;
 double shadow_radius = 8;
+const char *shadow_engine = "box";
+uint32_t shadow_downsample = 1;
+const char *glyph_cache_file = "glyph_cache.bin";
+const char *glyph_cache_charset = "";
 
 double danmaku_lifetime = 10;
 double danmaku_attack = 0.5;
 double danmaku_decay = 1;
+bool adaptive_lifetime = true;
+double danmaku_min_lifetime = 3;
+uint32_t max_danmaku_lines = 0;
 
 uint32_t max_fps = 60;
+bool adaptive_quality = true;
+uint32_t render_threads = 0;
+uint32_t tile_cache_size = 256;
+
+const char *frame_ring = "";
+uint32_t frame_ring_slots = 3;
+const char *video_output = "";
+const char *video_format = "y4m";
+uint32_t video_fps = 0;
+uint32_t video_queue_frames = 8;
+
+const char *offline_timeline = "";
+uint32_t offline_stage_height = 1080;
+double clock_step = 0;
+std::vector<std::string> input_sources = {"-"};
+uint32_t input_backlog = 256;
+const char *input_format = "text";
+const char *ingest_socket = "";
+uint32_t ingest_tcp_port = 0;
 
 }
 }
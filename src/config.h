@@ -20,6 +20,8 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 namespace dmhm {
 namespace config {
@@ -31,14 +33,41 @@ extern uint32_t extra_line_height;
 
 extern const char *font_file;
 extern uint32_t font_file_index;
+extern std::vector<std::string> fallback_font_files;
 extern double font_size;
 extern double shadow_radius;
+extern const char *shadow_engine;
+extern uint32_t shadow_downsample;
+extern const char *glyph_cache_file;
+extern const char *glyph_cache_charset;
 
 extern double danmaku_lifetime;
 extern double danmaku_attack;
 extern double danmaku_decay;
+extern bool adaptive_lifetime;
+extern double danmaku_min_lifetime;
+extern uint32_t max_danmaku_lines;
 
 extern uint32_t max_fps;
+extern bool adaptive_quality;
+extern uint32_t render_threads;
+extern uint32_t tile_cache_size;
+
+extern const char *frame_ring;
+extern uint32_t frame_ring_slots;
+extern const char *video_output;
+extern const char *video_format;
+extern uint32_t video_fps;
+extern uint32_t video_queue_frames;
+
+extern const char *offline_timeline;
+extern uint32_t offline_stage_height;
+extern double clock_step;
+extern std::vector<std::string> input_sources;
+extern uint32_t input_backlog;
+extern const char *input_format;
+extern const char *ingest_socket;
+extern uint32_t ingest_tcp_port;
 
 }
 }
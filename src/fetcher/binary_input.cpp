@@ -0,0 +1,206 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "binary_input.h"
+#include "binary_input_format.h"
+#include "input_format.h"
+#include "../utils.h"
+#include "../renderer/danmaku_entry.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace dmhm {
+
+/* Unknown frames are skipped this much at a time */
+static const size_t skip_chunk_bytes = 65536;
+
+static inline uint16_t load_le16(const char *data) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    return uint16_t(bytes[0] | bytes[1] << 8);
+}
+
+static inline uint32_t load_le32(const char *data) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+static inline uint64_t load_le64(const char *data) {
+    return uint64_t(load_le32(data)) | uint64_t(load_le32(data+4)) << 32;
+}
+
+struct BinaryInputReaderPrivate {
+    /* Bytes of the current batch frame not cut into records yet, 0 between frames */
+    uint32_t frame_left = 0;
+    /* Bytes of a frame of unknown type still to skip */
+    uint32_t skip_left = 0;
+    /* An unfinished frame header or record */
+    std::string partial;
+    const char *error = nullptr;
+    size_t unit_size(const char *unit, size_t size);
+    void take_unit(const char *unit, size_t size, const std::function<void (const char *record, size_t size)> &callback);
+};
+
+BinaryInputReader::BinaryInputReader() {
+}
+
+BinaryInputReader::~BinaryInputReader() {
+}
+
+bool BinaryInputReader::feed(const char *begin, const char *end, std::function<void (const char *record, size_t size)> callback) {
+    while(begin < end && !p->error) {
+        if(p->skip_left != 0) {
+            size_t skipped = std::min(size_t(p->skip_left), size_t(end-begin));
+            begin += skipped;
+            p->skip_left -= uint32_t(skipped);
+            continue;
+        }
+        if(!p->partial.empty()) {
+            size_t size = p->unit_size(p->partial.data(), p->partial.size());
+            if(size == 0)
+                break;
+            size_t taken = std::min(size-p->partial.size(), size_t(end-begin));
+            p->partial.append(begin, taken);
+            begin += taken;
+            /* Once a record header is complete, the size of the record is known */
+            size = p->unit_size(p->partial.data(), p->partial.size());
+            if(size == 0)
+                break;
+            if(p->partial.size() < size)
+                continue;
+            p->take_unit(p->partial.data(), size, callback);
+            p->partial.clear();
+            continue;
+        }
+        size_t available = size_t(end-begin);
+        size_t size = p->unit_size(begin, available);
+        if(size == 0)
+            break;
+        if(available < size) {
+            p->partial.assign(begin, available);
+            break;
+        }
+        p->take_unit(begin, size, callback);
+        begin += size;
+    }
+    if(p->error) {
+        p->partial.clear();
+        return false;
+    }
+    return true;
+}
+
+size_t BinaryInputReader::bytes_wanted() const {
+    if(p->error)
+        return 0;
+    if(p->skip_left != 0)
+        return std::min(size_t(p->skip_left), skip_chunk_bytes);
+    size_t size = p->unit_size(p->partial.data(), p->partial.size());
+    return size == 0 ? 0 : size-p->partial.size();
+}
+
+size_t BinaryInputReader::bytes_waiting() const {
+    return p->partial.size();
+}
+
+const char *BinaryInputReader::error() const {
+    return p->error;
+}
+
+/* Bytes of the frame header or record starting at unit, as far as the first size bytes tell,
+   0 if the stream is broken */
+size_t BinaryInputReaderPrivate::unit_size(const char *unit, size_t size) {
+    if(frame_left == 0)
+        return DMHM_INPUT_FRAME_HEADER_SIZE;
+    if(frame_left < DMHM_INPUT_RECORD_HEADER_SIZE) {
+        error = "a frame ends inside a record header";
+        return 0;
+    }
+    if(size < DMHM_INPUT_RECORD_HEADER_SIZE)
+        return DMHM_INPUT_RECORD_HEADER_SIZE;
+    uint32_t record_size = load_le32(unit);
+    if(record_size > DMHM_INPUT_MAX_RECORD_SIZE-DMHM_INPUT_RECORD_HEADER_SIZE) {
+        error = "a record is too long";
+        return 0;
+    }
+    if(record_size > frame_left-DMHM_INPUT_RECORD_HEADER_SIZE) {
+        error = "a record runs past the end of its frame";
+        return 0;
+    }
+    return DMHM_INPUT_RECORD_HEADER_SIZE+size_t(record_size);
+}
+
+void BinaryInputReaderPrivate::take_unit(const char *unit, size_t size, const std::function<void (const char *record, size_t size)> &callback) {
+    if(frame_left != 0) {
+        frame_left -= uint32_t(size);
+        callback(unit, size);
+        return;
+    }
+    if(load_le16(unit) != DMHM_INPUT_FRAME_MAGIC) {
+        error = "it does not look like the binary input format";
+        return;
+    }
+    uint32_t frame_size = load_le32(unit+4);
+    if(load_le16(unit+2) == DMHM_INPUT_FRAME_BATCH)
+        frame_left = frame_size;
+    else
+        skip_left = frame_size;
+}
+
+bool decode_binary_record(const char *record, size_t size, const std::string &prefix, DanmakuEntry &entry) {
+    uint16_t fields = load_le16(record+4);
+    size_t fields_size = load_le16(record+6);
+    size_t sender_size = load_le16(record+8);
+    if(DMHM_INPUT_RECORD_HEADER_SIZE+fields_size+sender_size > size)
+        return false;
+    const char *field = record+DMHM_INPUT_RECORD_HEADER_SIZE;
+    const char *fields_end = field+fields_size;
+    if(fields & DMHM_INPUT_FIELD_COLOR) {
+        if(fields_end-field < 4)
+            return false;
+        entry.has_color = true;
+        entry.color = load_le32(field) & 0xffffff;
+        field += 4;
+    }
+    if(fields & DMHM_INPUT_FIELD_PRIORITY) {
+        if(fields_end-field < 4)
+            return false;
+        entry.priority = int32_t(load_le32(field));
+        field += 4;
+    }
+    if(fields & DMHM_INPUT_FIELD_TIME) {
+        if(fields_end-field < 8)
+            return false;
+        entry.source_time = double(int64_t(load_le64(field))) / 1e6;
+        field += 8;
+    }
+    const char *sender = fields_end;
+    const char *text = sender+sender_size;
+    entry.message = prefix;
+    if(sender_size != 0) {
+        entry.sender = clean_input_text(sender, sender+sender_size);
+        entry.message += entry.sender+": ";
+    }
+    entry.message += clean_input_text(text, record+size);
+    return true;
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include "../renderer/danmaku_entry.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace dmhm {
+
+/* Cuts a stream in the binary input format, see binary_input_format.h, into
+   records as it arrives. Records that arrive whole are handed out where they
+   are, only one cut by the end of a read is copied until the rest arrives */
+class BinaryInputReader {
+
+public:
+
+    BinaryInputReader();
+    ~BinaryInputReader();
+    /* Calls callback with every record that [begin, end) completes, header included.
+       Returns false once the stream is broken, see error() */
+    bool feed(const char *begin, const char *end, std::function<void (const char *record, size_t size)> callback);
+    /* Bytes that would complete the next frame header or record, or skip some of a frame */
+    size_t bytes_wanted() const;
+    /* Bytes of an unfinished record or frame header kept from earlier reads */
+    size_t bytes_waiting() const;
+    const char *error() const;
+
+private:
+
+    proxy_ptr<struct BinaryInputReaderPrivate> p;
+
+};
+
+/* Fills entry from a record, except for the timestamp. prefix goes before the text and the sender.
+   Returns false for a record that is not understood */
+bool decode_binary_record(const char *record, size_t size, const std::string &prefix, DanmakuEntry &entry);
+
+}
@@ -0,0 +1,69 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+/* The binary input format, input_format = "binary", for producers that send
+   many comments per write. Plain C so that frontends can include it.
+
+   The stream is a sequence of frames, each a dmhm_input_frame followed by size
+   bytes. A frame of type DMHM_INPUT_FRAME_BATCH holds any number of records
+   back to back, each a dmhm_input_record followed by its own size bytes:
+   first the optional fields flagged in "fields", in the order of their bits,
+   then sender_size bytes of sender, then the text, which is the rest of the
+   record. Sender and text are UTF-8, not terminated, and may hold newlines.
+   A record must end inside its frame and be at most DMHM_INPUT_MAX_RECORD_SIZE
+   bytes with its header. Frames of other types are skipped.
+
+   Every integer is little endian and nothing is aligned. fields_size covers
+   the fields that are present, so fields from newer versions of the format
+   are skipped by older readers, as long as they take higher bits.
+
+   A stream that breaks these rules is closed, as there is no way to find the
+   next frame. A producer should write whole frames, so that comments are not
+   held until the rest of a frame arrives. */
+
+#pragma once
+#include <stdint.h>
+
+#define DMHM_INPUT_FRAME_MAGIC 0x4d44 /* "DM" in little endian */
+#define DMHM_INPUT_FRAME_HEADER_SIZE 8
+#define DMHM_INPUT_RECORD_HEADER_SIZE 12
+#define DMHM_INPUT_MAX_RECORD_SIZE 65536
+
+enum dmhm_input_frame_type {
+    DMHM_INPUT_FRAME_BATCH = 1
+};
+
+enum dmhm_input_field {
+    DMHM_INPUT_FIELD_COLOR    = 1 << 0, /* uint32_t 0xRRGGBB */
+    DMHM_INPUT_FIELD_PRIORITY = 1 << 1, /* int32_t */
+    DMHM_INPUT_FIELD_TIME     = 1 << 2  /* int64_t microseconds since the Unix epoch when it was sent */
+};
+
+struct dmhm_input_frame {
+    uint16_t magic;          /* DMHM_INPUT_FRAME_MAGIC */
+    uint16_t type;           /* dmhm_input_frame_type */
+    uint32_t size;           /* Bytes after this header */
+};
+
+struct dmhm_input_record {
+    uint32_t size;           /* Bytes after this header */
+    uint16_t fields;         /* dmhm_input_field flags */
+    uint16_t fields_size;    /* Bytes of the fields after this header */
+    uint16_t sender_size;    /* Bytes of sender after the fields, 0 for none */
+    uint16_t reserved;       /* 0 */
+};
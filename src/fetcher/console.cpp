@@ -20,14 +20,26 @@
 #include "console.h"
 #include "../utils.h"
 #include "../app.h"
+#include "../clock.h"
+#include "../config.h"
 #include "../renderer/danmaku_entry.h"
+#include "binary_input.h"
+#include "input_format.h"
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <iostream>
 #include <list>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <cstdio>
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 namespace dmhm {
 
@@ -36,8 +48,11 @@ struct ConsoleFetcherPrivate {
     std::thread thread;
     std::atomic<bool> is_eof = {false};
     std::mutex mutex;
+    std::condition_variable message_cond;
     std::list<DanmakuEntry> message_queue;
     void do_run(ConsoleFetcher *pub);
+    void read_binary();
+    void push_message(DanmakuEntry &entry);
 };
 
 ConsoleFetcher::ConsoleFetcher(Application *app) {
@@ -65,13 +80,58 @@ void ConsoleFetcher::pop_messages(std::function<void (DanmakuEntry &entry)> call
     }
 }
 
+void ConsoleFetcher::wait_messages(std::chrono::steady_clock::duration timeout) {
+    std::unique_lock<std::mutex> lock(p->mutex);
+    p->message_cond.wait_for(lock, timeout, [&]() {
+        return !p->message_queue.empty() || p->is_eof;
+    });
+}
+
 void ConsoleFetcherPrivate::do_run(ConsoleFetcher *pub) {
-    std::string input_buffer;
-    while(std::getline(std::cin, input_buffer)) {
-        std::unique_lock<std::mutex> lock(mutex);
-        message_queue.push_back(DanmakuEntry(utf8_validify(input_buffer)));
+    InputFormat input_format = parse_input_format(config::input_format);
+    if(input_format == INPUT_FORMAT_BINARY)
+        read_binary();
+    else {
+        std::string input_buffer;
+        while(std::getline(std::cin, input_buffer)) {
+            DanmakuEntry entry(std::string(), std::chrono::steady_clock::time_point{});
+            if(decode_input_line(input_format, &input_buffer[0], &input_buffer[0]+input_buffer.size(), std::string(), entry))
+                push_message(entry);
+        }
     }
+    std::unique_lock<std::mutex> lock(mutex);
     is_eof = true;
+    message_cond.notify_all();
+}
+
+/* Reads exactly what completes the next frame header or record, so nothing waits for more input than it needs */
+void ConsoleFetcherPrivate::read_binary() {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    BinaryInputReader reader;
+    std::vector<char> input_buffer;
+    for(;;) {
+        input_buffer.resize(reader.bytes_wanted());
+        if(!std::cin.read(input_buffer.data(), std::streamsize(input_buffer.size())))
+            break;
+        bool intact = reader.feed(input_buffer.data(), input_buffer.data()+input_buffer.size(), [&](const char *record, size_t size) {
+            DanmakuEntry entry(std::string(), std::chrono::steady_clock::time_point{});
+            if(decode_binary_record(record, size, std::string(), entry))
+                push_message(entry);
+        });
+        if(!intact) {
+            std::cerr << "Input: closing stdin, " << reader.error() << std::endl;
+            break;
+        }
+    }
+}
+
+void ConsoleFetcherPrivate::push_message(DanmakuEntry &entry) {
+    std::unique_lock<std::mutex> lock(mutex);
+    entry.timestamp = app->get_clock()->now();
+    message_queue.push_back(std::move(entry));
+    message_cond.notify_all();
 }
 
 }
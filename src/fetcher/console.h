@@ -22,6 +22,7 @@
 #include "../utils.h"
 #include "../app.h"
 #include "../renderer/danmaku_entry.h"
+#include <chrono>
 #include <functional>
 
 namespace dmhm {
@@ -35,6 +36,8 @@ public:
     void run_thread();
     bool is_eof();
     void pop_messages(std::function<void (DanmakuEntry &entry)> callback);
+    /* Returns early when a message arrives or input ends */
+    void wait_messages(std::chrono::steady_clock::duration timeout);
 
 private:
 
@@ -0,0 +1,658 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "epoll.h"
+#include "../utils.h"
+#include "../app.h"
+#include "../clock.h"
+#include "../config.h"
+#include "../renderer/danmaku_entry.h"
+#include "binary_input.h"
+#include "input_format.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+namespace dmhm {
+
+#ifdef __linux__
+
+/* Lines handed to the renderer but not taken yet, only this many,
+   so the turn order of sources decides what comes next */
+static const size_t message_queue_lines = 64;
+/* A longer line is dropped whole */
+static const size_t max_line_bytes = 65536;
+static const size_t read_chunk_bytes = 65536;
+/* More clients of the ingest server are turned away */
+static const size_t max_ingest_clients = 256;
+
+struct InputSource {
+    std::string name;
+    std::string prefix; // "[tag] " or empty
+    int fd = -1;
+    /* Flags of a description shared with other processes, put back when closed, or -1 */
+    int restore_flags = -1;
+    /* Regular files cannot be polled, they are read whenever they are behind */
+    bool pollable = true;
+    /* Listening sockets of the ingest server accept clients instead,
+       clients are dropped once they hang up and their lines are taken */
+    bool is_listener = false;
+    bool is_client = false;
+    bool reading = false;
+    bool is_eof = false;
+    std::string partial_line;
+    /* Inside a line over max_line_bytes, which is skipped up to its newline */
+    bool skipping_line = false;
+    /* Only with input_format = "binary", which has no lines */
+    std::unique_ptr<BinaryInputReader> binary_reader;
+    /* Decoded, but stamped when taken */
+    std::deque<DanmakuEntry> lines;
+    uint64_t line_count = 0;
+    uint64_t malformed_count = 0;
+    uint64_t oversized_count = 0;
+    uint64_t byte_count = 0;
+    uint64_t stats_line_count = 0;
+    uint64_t stats_byte_count = 0;
+};
+
+struct EpollFetcherPrivate {
+    Application *app = nullptr;
+    std::thread thread;
+    int epoll_fd = -1;
+    /* Written by pop_messages when the queue was full, and by the destructor */
+    int wake_fd = -1;
+    std::atomic<bool> stopping = {false};
+    std::atomic<bool> is_eof = {false};
+    std::vector<std::unique_ptr<InputSource>> sources;
+    size_t next_source = 0;
+    std::vector<char> read_buffer;
+    InputFormat input_format = INPUT_FORMAT_TEXT;
+    size_t client_count = 0;
+    std::string ingest_socket_path;
+    std::chrono::steady_clock::time_point stats_checkpoint;
+
+    std::mutex mutex;
+    std::condition_variable message_cond;
+    std::list<DanmakuEntry> message_queue;
+    bool queue_full = false;
+
+    void open_source(const std::string &spec);
+    void open_unix_listener(const char *path);
+    void open_tcp_listener(uint16_t port);
+    bool add_source(std::unique_ptr<InputSource> &source);
+    void set_reading(InputSource &source, bool reading);
+    void read_source(InputSource &source);
+    void push_line(InputSource &source, char *begin, char *end);
+    void push_record(InputSource &source, const char *record, size_t size);
+    void accept_clients(InputSource &listener);
+    void end_source(InputSource &source);
+    void drop_ended_clients();
+    void take_lines();
+    bool all_ended() const;
+    void print_stats(std::chrono::steady_clock::time_point now);
+    void do_run();
+};
+
+/* A description of its own for an inherited descriptor, so O_NONBLOCK does not reach the
+   shell or whoever else reads it, what cannot be reopened (sockets, regular files, which would
+   lose their offset) is shared and gets its flags back when closed */
+static int reopen_inherited(int fd, int &restore_flags) {
+    int flags = fcntl(fd, F_GETFL);
+    struct stat file_stat;
+    if(flags == -1 || fstat(fd, &file_stat) != 0)
+        return -1;
+    if(!S_ISREG(file_stat.st_mode)) {
+        /* Without O_NONBLOCK, opening a pipe whose writer is gone would wait forever */
+        int new_fd = open(("/proc/self/fd/"+std::to_string(fd)).c_str(), (flags & O_ACCMODE) | O_NONBLOCK | O_CLOEXEC);
+        if(new_fd != -1)
+            return new_fd;
+    }
+    restore_flags = flags;
+    return fcntl(fd, F_DUPFD_CLOEXEC, 3);
+}
+
+static void close_source(InputSource &source) {
+    if(source.restore_flags != -1)
+        fcntl(source.fd, F_SETFL, source.restore_flags);
+    close(source.fd);
+    source.fd = -1;
+}
+
+EpollFetcher::EpollFetcher(Application *app) {
+    p->app = app;
+    p->input_format = parse_input_format(config::input_format);
+    p->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    dmhm_assert(p->epoll_fd != -1);
+    p->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    dmhm_assert(p->wake_fd != -1);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    dmhm_assert(epoll_ctl(p->epoll_fd, EPOLL_CTL_ADD, p->wake_fd, &event) == 0);
+    for(const std::string &i : config::input_sources)
+        p->open_source(i);
+    if(*config::ingest_socket != '\0')
+        p->open_unix_listener(config::ingest_socket);
+    if(config::ingest_tcp_port != 0)
+        p->open_tcp_listener(uint16_t(config::ingest_tcp_port));
+    p->stats_checkpoint = std::chrono::steady_clock::now();
+}
+
+EpollFetcher::~EpollFetcher() {
+    if(p->thread.joinable()) {
+        p->stopping = true;
+        uint64_t one = 1;
+        if(write(p->wake_fd, &one, sizeof one) != sizeof one)
+            std::cerr << "Input: failed to stop: " << std::strerror(errno) << std::endl;
+        p->thread.join();
+    }
+    for(std::unique_ptr<InputSource> &i : p->sources)
+        if(i->fd != -1)
+            close_source(*i);
+    close(p->wake_fd);
+    close(p->epoll_fd);
+    if(!p->ingest_socket_path.empty())
+        unlink(p->ingest_socket_path.c_str());
+}
+
+void EpollFetcher::run_thread() {
+    p->thread = std::thread([&]() {
+        p->do_run();
+    });
+}
+
+bool EpollFetcher::is_eof() {
+    return p->is_eof;
+}
+
+void EpollFetcher::pop_messages(std::function<void (DanmakuEntry &entry)> callback) {
+    bool was_full;
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        while(!p->message_queue.empty()) {
+            callback(p->message_queue.front());
+            p->message_queue.pop_front();
+        }
+        was_full = p->queue_full;
+        p->queue_full = false;
+    }
+    if(was_full) {
+        uint64_t one = 1;
+        if(write(p->wake_fd, &one, sizeof one) != sizeof one)
+            std::cerr << "Input: failed to wake the reader: " << std::strerror(errno) << std::endl;
+    }
+}
+
+void EpollFetcher::wait_messages(std::chrono::steady_clock::duration timeout) {
+    std::unique_lock<std::mutex> lock(p->mutex);
+    p->message_cond.wait_for(lock, timeout, [&]() {
+        return !p->message_queue.empty() || p->is_eof;
+    });
+}
+
+/* "[tag=]spec", where spec is "-" for stdin, "fd:N" for an inherited descriptor,
+   "unix:/path" for a stream socket to connect to, or a file or named pipe */
+void EpollFetcherPrivate::open_source(const std::string &spec) {
+    std::unique_ptr<InputSource> source(new InputSource);
+    std::string path = spec;
+    size_t equals = spec.find('=');
+    if(equals != std::string::npos && spec.find_first_of("/:") > equals) {
+        if(equals != 0)
+            source->prefix = "["+spec.substr(0, equals)+"] ";
+        path = spec.substr(equals+1);
+    }
+    source->name = spec;
+
+    if(path == "-")
+        source->fd = reopen_inherited(0, source->restore_flags);
+    else if(path.compare(0, 3, "fd:") == 0) {
+        int fd = std::atoi(path.c_str()+3);
+        source->fd = reopen_inherited(fd, source->restore_flags);
+        if(source->fd != -1 && fd > 2)
+            close(fd);
+    }
+    else if(path.compare(0, 5, "unix:") == 0) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if(path.size()-5 >= sizeof address.sun_path) {
+            std::cerr << "Input: socket path too long in " << spec << std::endl;
+            return;
+        }
+        std::strcpy(address.sun_path, path.c_str()+5);
+        source->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(source->fd != -1 && connect(source->fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0) {
+            int connect_errno = errno;
+            close(source->fd);
+            source->fd = -1;
+            errno = connect_errno;
+        }
+    } else {
+        /* Holding the write end too, a named pipe never ends, so producers can come and go */
+        struct stat file_stat;
+        bool is_fifo = stat(path.c_str(), &file_stat) == 0 && S_ISFIFO(file_stat.st_mode);
+        source->fd = open(path.c_str(), (is_fifo ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    }
+    if(source->fd == -1) {
+        std::cerr << "Input: failed to open " << spec << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    add_source(source);
+}
+
+/* A stale socket file left by a crash is replaced, a live socket or anything else at path is not */
+void EpollFetcherPrivate::open_unix_listener(const char *path) {
+    std::unique_ptr<InputSource> listener(new InputSource);
+    listener->name = std::string("unix:")+path;
+    listener->is_listener = true;
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    dmhm_assert(std::strlen(path) < sizeof address.sun_path);
+    std::strcpy(address.sun_path, path);
+    struct stat file_stat;
+    if(lstat(path, &file_stat) == 0 && S_ISSOCK(file_stat.st_mode)) {
+        /* Only nobody listening refuses, anything else may be a running instance */
+        int probe_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool stale = probe_fd != -1 && connect(probe_fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 && errno == ECONNREFUSED;
+        if(probe_fd != -1)
+            close(probe_fd);
+        if(!stale) {
+            std::cerr << "Ingest: " << listener->name << " is in use by another running instance, not listening" << std::endl;
+            return;
+        }
+        unlink(path);
+    }
+    listener->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(listener->fd == -1 || bind(listener->fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 || listen(listener->fd, SOMAXCONN) != 0) {
+        std::cerr << "Ingest: failed to listen on " << listener->name << ": " << std::strerror(errno) << std::endl;
+        if(listener->fd != -1)
+            close(listener->fd);
+        return;
+    }
+    ingest_socket_path = path;
+    if(add_source(listener))
+        std::cerr << "Ingest: listening on " << sources.back()->name << std::endl;
+}
+
+/* Only on the loopback address, there is no authentication */
+void EpollFetcherPrivate::open_tcp_listener(uint16_t port) {
+    std::unique_ptr<InputSource> listener(new InputSource);
+    listener->name = "127.0.0.1:"+std::to_string(port);
+    listener->is_listener = true;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    int reuse = 1;
+    listener->fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(listener->fd == -1 || setsockopt(listener->fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof reuse) != 0 || bind(listener->fd, reinterpret_cast<sockaddr *>(&address), sizeof address) != 0 || listen(listener->fd, SOMAXCONN) != 0) {
+        std::cerr << "Ingest: failed to listen on " << listener->name << ": " << std::strerror(errno) << std::endl;
+        if(listener->fd != -1)
+            close(listener->fd);
+        return;
+    }
+    if(add_source(listener))
+        std::cerr << "Ingest: listening on " << sources.back()->name << std::endl;
+}
+
+/* Takes over the descriptor, or closes it on failure */
+bool EpollFetcherPrivate::add_source(std::unique_ptr<InputSource> &source) {
+    int flags = fcntl(source->fd, F_GETFL);
+    if(flags == -1 || fcntl(source->fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        std::cerr << "Input: bad descriptor in " << source->name << ": " << std::strerror(errno) << std::endl;
+        if(source->fd > 2)
+            close(source->fd);
+        return false;
+    }
+    if(input_format == INPUT_FORMAT_BINARY && !source->is_listener)
+        source->binary_reader.reset(new BinaryInputReader);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = source.get();
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, source->fd, &event) == 0)
+        source->reading = true;
+    else if(errno == EPERM && !source->is_listener && !source->is_client)
+        source->pollable = false;
+    else {
+        std::cerr << "Input: failed to poll " << source->name << ": " << std::strerror(errno) << std::endl;
+        close_source(*source);
+        return false;
+    }
+    sources.push_back(std::move(source));
+    return true;
+}
+
+/* A source with a full backlog leaves the epoll set, rather than being masked,
+   since a hang-up would still be reported over and over */
+void EpollFetcherPrivate::set_reading(InputSource &source, bool reading) {
+    if(source.reading == reading || source.is_eof)
+        return;
+    source.reading = reading;
+    if(!source.pollable)
+        return;
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = &source;
+    dmhm_assert(epoll_ctl(epoll_fd, reading ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, source.fd, &event) == 0);
+}
+
+/* One read per wake-up, so every ready source gets a turn */
+void EpollFetcherPrivate::read_source(InputSource &source) {
+    ssize_t bytes_read = read(source.fd, read_buffer.data(), read_buffer.size());
+    if(bytes_read < 0) {
+        if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return;
+        std::cerr << "Input: failed to read " << source.name << ": " << std::strerror(errno) << std::endl;
+        end_source(source);
+        return;
+    }
+    if(bytes_read == 0) {
+        end_source(source);
+        return;
+    }
+    source.byte_count += uint64_t(bytes_read);
+    if(source.binary_reader) {
+        bool intact = source.binary_reader->feed(read_buffer.data(), read_buffer.data()+bytes_read, [&](const char *record, size_t size) {
+            push_record(source, record, size);
+        });
+        if(!intact) {
+            std::cerr << "Input: closing " << source.name << ", " << source.binary_reader->error() << std::endl;
+            end_source(source);
+        }
+        return;
+    }
+    char *data = read_buffer.data();
+    char *end = data + bytes_read;
+    while(data < end) {
+        char *line_end = static_cast<char *>(std::memchr(data, '\n', size_t(end-data)));
+        size_t length = size_t((line_end ? line_end : end) - data);
+        if(source.skipping_line) {
+            source.skipping_line = !line_end;
+            data = line_end ? line_end+1 : end;
+            continue;
+        }
+        /* Whole lines are decoded where they were read */
+        if(line_end && source.partial_line.empty() && length <= max_line_bytes) {
+            push_line(source, data, line_end);
+            data = line_end+1;
+            continue;
+        }
+        /* Cut into pieces, it would show as comments nobody sent */
+        if(source.partial_line.size()+length > max_line_bytes) {
+            if(source.oversized_count++ == 0)
+                std::cerr << "Input: dropped a line over " << max_line_bytes << " bytes from " << source.name << ", more are only counted" << std::endl;
+            source.partial_line.clear();
+            source.skipping_line = !line_end;
+            data = line_end ? line_end+1 : end;
+            continue;
+        }
+        source.partial_line.append(data, length);
+        data += length;
+        if(!line_end)
+            break;
+        data++;
+        push_line(source, &source.partial_line[0], &source.partial_line[0]+source.partial_line.size());
+        source.partial_line.clear();
+    }
+}
+
+void EpollFetcherPrivate::push_line(InputSource &source, char *begin, char *end) {
+    DanmakuEntry entry(std::string(), std::chrono::steady_clock::time_point{});
+    if(!decode_input_line(input_format, begin, end, source.prefix, entry)) {
+        source.malformed_count++;
+        return;
+    }
+    source.lines.push_back(std::move(entry));
+    source.line_count++;
+}
+
+void EpollFetcherPrivate::push_record(InputSource &source, const char *record, size_t size) {
+    DanmakuEntry entry(std::string(), std::chrono::steady_clock::time_point{});
+    if(!decode_binary_record(record, size, source.prefix, entry)) {
+        source.malformed_count++;
+        return;
+    }
+    source.lines.push_back(std::move(entry));
+    source.line_count++;
+}
+
+/* A few at a time, so a storm of connections does not hold up reading */
+void EpollFetcherPrivate::accept_clients(InputSource &listener) {
+    for(int i = 0; i < 16; i++) {
+        sockaddr_storage address;
+        socklen_t address_size = sizeof address;
+        int fd = accept4(listener.fd, reinterpret_cast<sockaddr *>(&address), &address_size, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd == -1) {
+            if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED)
+                std::cerr << "Ingest: failed to accept on " << listener.name << ": " << std::strerror(errno) << std::endl;
+            return;
+        }
+        std::unique_ptr<InputSource> client(new InputSource);
+        client->fd = fd;
+        client->is_client = true;
+        client_count++;
+        if(address.ss_family == AF_INET) {
+            const sockaddr_in &inet_address = reinterpret_cast<const sockaddr_in &>(address);
+            char host[INET_ADDRSTRLEN] = "";
+            inet_ntop(AF_INET, &inet_address.sin_addr, host, sizeof host);
+            client->name = std::string(host)+":"+std::to_string(ntohs(inet_address.sin_port));
+        } else
+            client->name = listener.name+"#"+std::to_string(client_count);
+        size_t clients = 0;
+        for(const std::unique_ptr<InputSource> &j : sources)
+            clients += j->is_client;
+        if(clients >= max_ingest_clients) {
+            std::cerr << "Ingest: turned away " << client->name << ", " << clients << " clients already" << std::endl;
+            close(fd);
+            continue;
+        }
+        if(add_source(client))
+            std::cerr << "Ingest: " << sources.back()->name << " connected" << std::endl;
+    }
+}
+
+void EpollFetcherPrivate::end_source(InputSource &source) {
+    set_reading(source, false);
+    source.is_eof = true;
+    if(!source.partial_line.empty()) {
+        push_line(source, &source.partial_line[0], &source.partial_line[0]+source.partial_line.size());
+        source.partial_line.clear();
+    }
+    if(source.binary_reader && source.binary_reader->bytes_waiting() != 0)
+        source.malformed_count++;
+    close_source(source);
+    std::cerr << (source.is_client ? "Ingest: " : "Input: ") << source.name << " ended after " << source.line_count << " lines";
+    if(source.malformed_count != 0)
+        std::cerr << ", skipped " << source.malformed_count << " it did not understand";
+    if(source.oversized_count != 0)
+        std::cerr << ", dropped " << source.oversized_count << " over " << max_line_bytes << " bytes";
+    std::cerr << std::endl;
+}
+
+void EpollFetcherPrivate::drop_ended_clients() {
+    for(size_t i = 0; i < sources.size();)
+        if(sources[i]->is_client && sources[i]->is_eof && sources[i]->lines.empty()) {
+            sources.erase(sources.begin()+ptrdiff_t(i));
+            if(next_source > i)
+                next_source--;
+        } else
+            i++;
+    if(next_source >= sources.size())
+        next_source = 0;
+}
+
+/* One line from each source in turn, resuming where the last call stopped */
+void EpollFetcherPrivate::take_lines() {
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t idle_sources = 0;
+    bool taken = false;
+    while(idle_sources < sources.size()) {
+        if(message_queue.size() >= message_queue_lines) {
+            queue_full = true;
+            break;
+        }
+        InputSource &source = *sources[next_source];
+        next_source = (next_source+1) % sources.size();
+        if(source.lines.empty()) {
+            idle_sources++;
+            continue;
+        }
+        idle_sources = 0;
+        message_queue.push_back(std::move(source.lines.front()));
+        message_queue.back().timestamp = app->get_clock()->now();
+        source.lines.pop_front();
+        taken = true;
+    }
+    if(taken)
+        message_cond.notify_all();
+}
+
+/* Never while the ingest server is listening */
+bool EpollFetcherPrivate::all_ended() const {
+    for(const std::unique_ptr<InputSource> &i : sources)
+        if(!i->is_eof || !i->lines.empty())
+            return false;
+    return true;
+}
+
+/* Rates over the last interval and what each client of the ingest server has waiting,
+   a client with input_backlog lines waiting is not being read */
+void EpollFetcherPrivate::print_stats(std::chrono::steady_clock::time_point now) {
+    double seconds = std::chrono::duration<double>(now-stats_checkpoint).count();
+    stats_checkpoint = now;
+    for(std::unique_ptr<InputSource> &i : sources) {
+        if(!i->is_client)
+            continue;
+        size_t bytes_waiting = i->binary_reader ? i->binary_reader->bytes_waiting() : i->partial_line.size();
+        uint64_t lines = i->line_count-i->stats_line_count;
+        uint64_t bytes = i->byte_count-i->stats_byte_count;
+        i->stats_line_count = i->line_count;
+        i->stats_byte_count = i->byte_count;
+        std::cerr << "Ingest: " << i->name << " " << lines/seconds << " lines/s, " << bytes/seconds/1024 << " KiB/s, "
+            << i->lines.size() << " lines and " << bytes_waiting << " bytes waiting" << (i->reading ? "" : " (throttled)")
+            << ", " << i->line_count << " lines in total, " << i->malformed_count << " not understood, " << i->oversized_count << " too long" << std::endl;
+    }
+}
+
+void EpollFetcherPrivate::do_run() {
+    read_buffer.resize(read_chunk_bytes);
+    std::vector<epoll_event> events(64);
+    bool listening = false;
+    for(std::unique_ptr<InputSource> &i : sources)
+        listening = listening || i->is_listener;
+    while(!stopping) {
+        take_lines();
+        drop_ended_clients();
+        if(all_ended())
+            break;
+        bool files_behind = false;
+        for(std::unique_ptr<InputSource> &i : sources) {
+            if(!i->is_listener)
+                set_reading(*i, i->lines.size() < config::input_backlog);
+            files_behind = files_behind || (!i->pollable && i->reading);
+        }
+
+        int timeout = -1;
+        if(listening) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if(now-stats_checkpoint >= std::chrono::seconds(10)) {
+                print_stats(now);
+                now = stats_checkpoint;
+            }
+            timeout = int(std::chrono::duration_cast<std::chrono::milliseconds>(stats_checkpoint+std::chrono::seconds(10)-now).count())+1;
+        }
+        if(files_behind)
+            timeout = 0;
+        int event_count = epoll_wait(epoll_fd, events.data(), int(events.size()), timeout);
+        if(event_count < 0) {
+            dmhm_assert(errno == EINTR);
+            continue;
+        }
+        for(int i = 0; i < event_count; i++) {
+            InputSource *source = static_cast<InputSource *>(events[i].data.ptr);
+            if(source && source->is_listener)
+                accept_clients(*source);
+            else if(source) {
+                if(source->reading)
+                    read_source(*source);
+            } else {
+                uint64_t count;
+                if(read(wake_fd, &count, sizeof count) < 0 && errno != EAGAIN)
+                    std::cerr << "Input: failed to read the wake-up: " << std::strerror(errno) << std::endl;
+            }
+        }
+        for(std::unique_ptr<InputSource> &i : sources)
+            if(!i->pollable && i->reading)
+                read_source(*i);
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    is_eof = true;
+    message_cond.notify_all();
+}
+
+#else
+
+struct EpollFetcherPrivate {
+};
+
+EpollFetcher::EpollFetcher(Application *) {
+    dmhm_assert(!"EpollFetcher is Linux only");
+}
+
+EpollFetcher::~EpollFetcher() {
+}
+
+void EpollFetcher::run_thread() {
+}
+
+bool EpollFetcher::is_eof() {
+    return true;
+}
+
+void EpollFetcher::pop_messages(std::function<void (DanmakuEntry &entry)>) {
+}
+
+void EpollFetcher::wait_messages(std::chrono::steady_clock::duration) {
+}
+
+#endif
+
+}
@@ -0,0 +1,52 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include "../app.h"
+#include "../renderer/danmaku_entry.h"
+#include <chrono>
+#include <functional>
+
+namespace dmhm {
+
+/* Reads lines from every input_sources entry on one thread with epoll, Linux only.
+   Each source is buffered on its own and its lines are taken in turn, a source with
+   input_backlog lines waiting is not read until they are taken, so a flood from one
+   source only slows down that source. Input ends when every source has ended */
+class EpollFetcher {
+
+public:
+
+    EpollFetcher(Application *app);
+    ~EpollFetcher();
+    void run_thread();
+    bool is_eof();
+    void pop_messages(std::function<void (DanmakuEntry &entry)> callback);
+    /* Returns early when a message arrives or input ends */
+    void wait_messages(std::chrono::steady_clock::duration timeout);
+
+private:
+
+    proxy_ptr<struct EpollFetcherPrivate> p;
+
+};
+
+}
@@ -19,12 +19,20 @@
 
 #pragma once
 
+#ifdef __linux__
+#include "epoll.h"
+#else
 #include "console.h"
+#endif
 
 namespace dmhm {
 
 struct BaseFetcher; // Opaque type
 
+#ifdef __linux__
+typedef EpollFetcher Fetcher;
+#else
 typedef ConsoleFetcher Fetcher;
+#endif
 
 }
@@ -0,0 +1,82 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "input_format.h"
+#include "json_line.h"
+#include "../utils.h"
+#include "../renderer/danmaku_entry.h"
+#include <cstring>
+#include <string>
+
+namespace dmhm {
+
+static const struct {
+    const char *name;
+    InputFormat format;
+} input_format_names[] = {
+    {"text", INPUT_FORMAT_TEXT},
+    {"json", INPUT_FORMAT_JSON},
+    {"binary", INPUT_FORMAT_BINARY}
+};
+
+InputFormat parse_input_format(const char *name) {
+    for(const auto &i : input_format_names)
+        if(std::strcmp(name, i.name) == 0)
+            return i.format;
+    dmhm_assert(!"Unknown input format");
+    return INPUT_FORMAT_TEXT;
+}
+
+bool is_valid_input_format(const char *name) {
+    for(const auto &i : input_format_names)
+        if(std::strcmp(name, i.name) == 0)
+            return true;
+    return false;
+}
+
+std::string clean_input_text(const char *begin, const char *end) {
+    std::string text(begin, end);
+    for(char &c : text)
+        if(static_cast<unsigned char>(c) < 0x20)
+            c = ' ';
+    return utf8_validify(text);
+}
+
+bool decode_input_line(InputFormat format, char *begin, char *end, const std::string &prefix, DanmakuEntry &entry) {
+    if(format == INPUT_FORMAT_TEXT) {
+        entry.message = prefix+clean_input_text(begin, end);
+        return true;
+    }
+    JsonLine line;
+    if(!parse_json_line(begin, end, line))
+        return false;
+    entry.message = prefix;
+    if(line.sender_size != 0) {
+        entry.sender = clean_input_text(line.sender, line.sender+line.sender_size);
+        entry.message += entry.sender+": ";
+    }
+    entry.message += clean_input_text(line.text, line.text+line.text_size);
+    entry.has_color = line.has_color;
+    entry.color = line.color;
+    entry.priority = line.priority;
+    entry.source_time = line.time;
+    return true;
+}
+
+}
@@ -0,0 +1,46 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../renderer/danmaku_entry.h"
+#include <string>
+
+namespace dmhm {
+
+/* What fetchers read, chosen by input_format */
+enum InputFormat {
+    INPUT_FORMAT_TEXT,  // A comment per line
+    INPUT_FORMAT_JSON,  // A JSON object per line, see json_line.h
+    INPUT_FORMAT_BINARY // Length-prefixed records, not lines, see binary_input.h
+};
+
+InputFormat parse_input_format(const char *name);
+bool is_valid_input_format(const char *name);
+
+/* Text of a comment or a sender as shown: CR, LF and the other C0 controls become spaces,
+   so a line decoded from JSON or a binary record stays one line, then invalid UTF-8 is replaced */
+std::string clean_input_text(const char *begin, const char *end);
+
+/* For text and JSON. Fills entry from a line without its newline, except for the timestamp.
+   prefix goes before the text and the sender. The line may be changed in place.
+   Returns false for a line that is not understood */
+bool decode_input_line(InputFormat format, char *begin, char *end, const std::string &prefix, DanmakuEntry &entry);
+
+}
@@ -0,0 +1,315 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "json_line.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace dmhm {
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline void skip_space(char *&p, const char *end) {
+    while(p < end && is_space(*p))
+        p++;
+}
+
+static inline int hex_digit(char c) {
+    if(c >= '0' && c <= '9')
+        return c-'0';
+    if(c >= 'a' && c <= 'f')
+        return c-'a'+10;
+    if(c >= 'A' && c <= 'F')
+        return c-'A'+10;
+    return -1;
+}
+
+static bool parse_hex4(const char *p, const char *end, uint32_t &value) {
+    if(end-p < 4)
+        return false;
+    value = 0;
+    for(int i = 0; i < 4; i++) {
+        int digit = hex_digit(p[i]);
+        if(digit < 0)
+            return false;
+        value = value << 4 | uint32_t(digit);
+    }
+    return true;
+}
+
+static inline char *put_utf8(char *out, uint32_t codepoint) {
+    if(codepoint < 0x80)
+        *out++ = char(codepoint);
+    else if(codepoint < 0x800) {
+        *out++ = char(0xc0 | codepoint >> 6);
+        *out++ = char(0x80 | (codepoint & 0x3f));
+    } else if(codepoint < 0x10000) {
+        *out++ = char(0xe0 | codepoint >> 12);
+        *out++ = char(0x80 | (codepoint >> 6 & 0x3f));
+        *out++ = char(0x80 | (codepoint & 0x3f));
+    } else {
+        *out++ = char(0xf0 | codepoint >> 18);
+        *out++ = char(0x80 | (codepoint >> 12 & 0x3f));
+        *out++ = char(0x80 | (codepoint >> 6 & 0x3f));
+        *out++ = char(0x80 | (codepoint & 0x3f));
+    }
+    return out;
+}
+
+/* p is just past the opening quote, and is left just past the closing one.
+   Unescaped text never grows, so it is written over the escaped text */
+static bool parse_string(char *&p, const char *end, char *&value, size_t &value_size) {
+    value = p;
+    while(p < end && *p != '"' && *p != '\\')
+        p++;
+    char *out = p;
+    while(p < end && *p != '"') {
+        if(*p != '\\') {
+            *out++ = *p++;
+            continue;
+        }
+        if(++p == end)
+            return false;
+        switch(*p++) {
+        case '"': *out++ = '"'; break;
+        case '\\': *out++ = '\\'; break;
+        case '/': *out++ = '/'; break;
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
+        case 't': *out++ = '\t'; break;
+        case 'u': {
+            uint32_t codepoint;
+            if(!parse_hex4(p, end, codepoint))
+                return false;
+            p += 4;
+            if((codepoint & 0xfc00) == 0xd800) {
+                uint32_t low;
+                if(end-p >= 6 && p[0] == '\\' && p[1] == 'u' && parse_hex4(p+2, end, low) && (low & 0xfc00) == 0xdc00) {
+                    codepoint = 0x10000 + ((codepoint & 0x3ff) << 10 | (low & 0x3ff));
+                    p += 6;
+                } else
+                    codepoint = 0xfffd;
+            } else if((codepoint & 0xfc00) == 0xdc00)
+                codepoint = 0xfffd;
+            out = put_utf8(out, codepoint);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    if(p == end)
+        return false;
+    value_size = size_t(out-value);
+    p++;
+    return true;
+}
+
+/* Strings are only scanned, objects and arrays are matched by depth */
+static bool skip_value(char *&p, const char *end) {
+    uint32_t depth = 0;
+    do {
+        skip_space(p, end);
+        if(p == end)
+            return false;
+        char c = *p++;
+        if(c == '"') {
+            for(;;) {
+                const void *quote = std::memchr(p, '"', size_t(end-p));
+                if(!quote)
+                    return false;
+                const char *q = static_cast<const char *>(quote);
+                const char *backslashes = q;
+                while(backslashes > p && backslashes[-1] == '\\')
+                    backslashes--;
+                p = const_cast<char *>(q)+1;
+                if((q-backslashes) % 2 == 0)
+                    break;
+            }
+        } else if(c == '{' || c == '[')
+            depth++;
+        else if(c == '}' || c == ']') {
+            if(depth == 0)
+                return false;
+            depth--;
+        } else if(c == ',' || c == ':') {
+            if(depth == 0)
+                return false;
+        } else
+            while(p < end && !is_space(*p) && *p != ',' && *p != '}' && *p != ']' && *p != ':')
+                p++;
+    } while(depth != 0);
+    return true;
+}
+
+/* Without strtod, which follows the locale set by the toolkit */
+static bool parse_number(char *&p, const char *end, double &value) {
+    bool negative = p < end && *p == '-';
+    if(negative)
+        p++;
+    uint64_t mantissa = 0;
+    int32_t exponent = 0;
+    bool has_digits = false;
+    for(; p < end && *p >= '0' && *p <= '9'; p++, has_digits = true)
+        if(mantissa < UINT64_C(1000000000000000000))
+            mantissa = mantissa*10 + uint64_t(*p-'0');
+        else
+            exponent++;
+    if(p < end && *p == '.')
+        for(p++; p < end && *p >= '0' && *p <= '9'; p++, has_digits = true)
+            if(mantissa < UINT64_C(1000000000000000000)) {
+                mantissa = mantissa*10 + uint64_t(*p-'0');
+                exponent--;
+            }
+    if(!has_digits)
+        return false;
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = p < end && *p == '-';
+        if(p < end && (*p == '-' || *p == '+'))
+            p++;
+        int32_t written = 0;
+        bool has_exponent_digits = false;
+        for(; p < end && *p >= '0' && *p <= '9'; p++, has_exponent_digits = true)
+            if(written < 10000)
+                written = written*10 + (*p-'0');
+        if(!has_exponent_digits)
+            return false;
+        exponent += negative_exponent ? -written : written;
+    }
+    value = double(mantissa);
+    if(exponent != 0)
+        value = exponent > 0 ? value*std::pow(10.0, exponent) : value/std::pow(10.0, -exponent);
+    if(negative)
+        value = -value;
+    return true;
+}
+
+static bool parse_color(char *&p, const char *end, JsonLine &line) {
+    if(*p != '"' && *p != '-' && (*p < '0' || *p > '9'))
+        return skip_value(p, end);
+    if(*p != '"') {
+        double value;
+        if(!parse_number(p, end, value))
+            return false;
+        line.has_color = value >= 0 && value <= 0xffffff;
+        line.color = line.has_color ? uint32_t(value) : 0;
+        return true;
+    }
+    p++;
+    char *value;
+    size_t value_size;
+    if(!parse_string(p, end, value, value_size))
+        return false;
+    if(value_size == 7 && value[0] == '#') {
+        value++;
+        value_size--;
+    }
+    uint32_t color = 0;
+    for(size_t i = 0; i < value_size; i++) {
+        int digit = hex_digit(value[i]);
+        if(digit < 0 || value_size != 6)
+            return true;
+        color = color << 4 | uint32_t(digit);
+    }
+    line.has_color = value_size == 6;
+    line.color = color;
+    return true;
+}
+
+static inline bool key_is(const char *key, size_t key_size, const char *name, size_t name_size) {
+    return key_size == name_size && std::memcmp(key, name, name_size) == 0;
+}
+
+bool parse_json_line(char *begin, char *end, JsonLine &line) {
+    line = JsonLine();
+    char *p = begin;
+    skip_space(p, end);
+    if(p == end || *p++ != '{')
+        return false;
+    skip_space(p, end);
+    if(p < end && *p == '}')
+        p++;
+    else
+        for(;;) {
+            skip_space(p, end);
+            if(p == end || *p++ != '"')
+                return false;
+            char *key;
+            size_t key_size;
+            if(!parse_string(p, end, key, key_size))
+                return false;
+            skip_space(p, end);
+            if(p == end || *p++ != ':')
+                return false;
+            skip_space(p, end);
+            if(p == end)
+                return false;
+
+            if(key_is(key, key_size, "text", 4) || key_is(key, key_size, "sender", 6)) {
+                bool is_text = key_size == 4;
+                if(*p != '"') {
+                    if(!skip_value(p, end))
+                        return false;
+                } else {
+                    p++;
+                    char *value;
+                    size_t value_size;
+                    if(!parse_string(p, end, value, value_size))
+                        return false;
+                    (is_text ? line.text : line.sender) = value;
+                    (is_text ? line.text_size : line.sender_size) = value_size;
+                }
+            } else if(key_is(key, key_size, "color", 5)) {
+                if(!parse_color(p, end, line))
+                    return false;
+            } else if(key_is(key, key_size, "priority", 8) || key_is(key, key_size, "time", 4)) {
+                double value;
+                if(*p == '-' || (*p >= '0' && *p <= '9')) {
+                    if(!parse_number(p, end, value))
+                        return false;
+                    if(key_size == 4)
+                        line.time = value;
+                    else
+                        line.priority = int32_t(std::max(std::min(value, 2147483647.0), -2147483648.0));
+                } else if(!skip_value(p, end))
+                    return false;
+            } else if(!skip_value(p, end))
+                return false;
+
+            skip_space(p, end);
+            if(p == end)
+                return false;
+            char c = *p++;
+            if(c == '}')
+                break;
+            if(c != ',')
+                return false;
+        }
+    skip_space(p, end);
+    return p == end && line.text != nullptr;
+}
+
+}
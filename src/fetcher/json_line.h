@@ -0,0 +1,45 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dmhm {
+
+/* One comment as a JSON object on a line, with input_format = "json":
+   {"text": "Hello", "sender": "Alice", "color": "#ff8800", "priority": 1, "time": 1700000000.25}
+   Only text is required. color is "#rrggbb" or a number, time is in seconds since the Unix epoch,
+   other fields are skipped. Strings are unescaped in place, so they point into the line */
+struct JsonLine {
+    const char *text = nullptr;
+    size_t text_size = 0;
+    const char *sender = nullptr;
+    size_t sender_size = 0;
+    bool has_color = false;
+    uint32_t color = 0; // 0xRRGGBB
+    int32_t priority = 0;
+    double time = 0;
+};
+
+/* Returns false unless [begin, end) holds one object with a string text, without allocating */
+bool parse_json_line(char *begin, char *end, JsonLine &line);
+
+}
@@ -19,7 +19,16 @@
 
 #include "config.h"
 #include "utils.h"
+#include "fetcher/input_format.h"
+#include "renderer/blur.h"
+#include "renderer/video_sink.h"
+#include <cmath>
 #include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
 #include <confuse.h>
 
 namespace dmhm {
@@ -28,12 +37,39 @@ static char str_stage_width[] = "stage_width";
 static char str_extra_line_height[] = "extra_line_height";
 static char str_font_file[] = "font_file";
 static char str_font_file_index[] = "font_file_index";
+static char str_fallback_font_files[] = "fallback_font_files";
+static char str_fallback_font_files_default[] = "{}";
 static char str_font_size[] = "font_size";
 static char str_shadow_radius[] = "shadow_radius";
+static char str_shadow_engine[] = "shadow_engine";
+static char str_shadow_downsample[] = "shadow_downsample";
+static char str_glyph_cache_file[] = "glyph_cache_file";
+static char str_glyph_cache_charset[] = "glyph_cache_charset";
 static char str_danmaku_lifetime[] = "danmaku_lifetime";
 static char str_danmaku_attack[] = "danmaku_attack";
 static char str_danmaku_decay[] = "danmaku_decay";
+static char str_adaptive_lifetime[] = "adaptive_lifetime";
+static char str_danmaku_min_lifetime[] = "danmaku_min_lifetime";
+static char str_max_danmaku_lines[] = "max_danmaku_lines";
 static char str_max_fps[] = "max_fps";
+static char str_adaptive_quality[] = "adaptive_quality";
+static char str_render_threads[] = "render_threads";
+static char str_tile_cache_size[] = "tile_cache_size";
+static char str_frame_ring[] = "frame_ring";
+static char str_frame_ring_slots[] = "frame_ring_slots";
+static char str_video_output[] = "video_output";
+static char str_video_format[] = "video_format";
+static char str_video_fps[] = "video_fps";
+static char str_video_queue_frames[] = "video_queue_frames";
+static char str_offline_timeline[] = "offline_timeline";
+static char str_offline_stage_height[] = "offline_stage_height";
+static char str_clock_step[] = "clock_step";
+static char str_input_sources[] = "input_sources";
+static char str_input_sources_default[] = "{\"-\"}";
+static char str_input_backlog[] = "input_backlog";
+static char str_input_format[] = "input_format";
+static char str_ingest_socket[] = "ingest_socket";
+static char str_ingest_tcp_port[] = "ingest_tcp_port";
 
 int load_config(const char *config_filename) {
     long int stage_width = config::stage_width;
@@ -42,26 +78,83 @@ int load_config(const char *config_filename) {
     long int font_file_index = config::font_file_index;
     double font_size = config::font_size;
     double shadow_radius = config::shadow_radius;
+    char *shadow_engine = strdup(config::shadow_engine);
+    long int shadow_downsample = config::shadow_downsample;
+    char *glyph_cache_file = strdup(config::glyph_cache_file);
+    char *glyph_cache_charset = strdup(config::glyph_cache_charset);
     double danmaku_lifetime = config::danmaku_lifetime;
     double danmaku_attack = config::danmaku_attack;
     double danmaku_decay = config::danmaku_decay;
+    cfg_bool_t adaptive_lifetime = config::adaptive_lifetime ? cfg_true : cfg_false;
+    /* NaN until the config file sets it */
+    double danmaku_min_lifetime = std::numeric_limits<double>::quiet_NaN();
+    long int max_danmaku_lines = config::max_danmaku_lines;
     long int max_fps = config::max_fps;
+    cfg_bool_t adaptive_quality = config::adaptive_quality ? cfg_true : cfg_false;
+    long int render_threads = config::render_threads;
+    long int tile_cache_size = config::tile_cache_size;
+    char *frame_ring = strdup(config::frame_ring);
+    long int frame_ring_slots = config::frame_ring_slots;
+    char *video_output = strdup(config::video_output);
+    char *video_format = strdup(config::video_format);
+    long int video_fps = config::video_fps;
+    long int video_queue_frames = config::video_queue_frames;
+    char *offline_timeline = strdup(config::offline_timeline);
+    long int offline_stage_height = config::offline_stage_height;
+    double clock_step = config::clock_step;
+    long int input_backlog = config::input_backlog;
+    char *input_format = strdup(config::input_format);
+    char *ingest_socket = strdup(config::ingest_socket);
+    long int ingest_tcp_port = config::ingest_tcp_port;
 
     cfg_opt_t opts[] = {
         CFG_SIMPLE_INT(str_stage_width, &stage_width),
         CFG_SIMPLE_INT(str_extra_line_height, &extra_line_height),
         CFG_SIMPLE_STR(str_font_file, &font_file),
         CFG_SIMPLE_INT(str_font_file_index, &font_file_index),
+        CFG_STR_LIST(str_fallback_font_files, str_fallback_font_files_default, CFGF_NONE),
         CFG_SIMPLE_FLOAT(str_font_size, &font_size),
         CFG_SIMPLE_FLOAT(str_shadow_radius, &shadow_radius),
+        CFG_SIMPLE_STR(str_shadow_engine, &shadow_engine),
+        CFG_SIMPLE_INT(str_shadow_downsample, &shadow_downsample),
+        CFG_SIMPLE_STR(str_glyph_cache_file, &glyph_cache_file),
+        CFG_SIMPLE_STR(str_glyph_cache_charset, &glyph_cache_charset),
         CFG_SIMPLE_FLOAT(str_danmaku_lifetime, &danmaku_lifetime),
         CFG_SIMPLE_FLOAT(str_danmaku_attack, &danmaku_attack),
         CFG_SIMPLE_FLOAT(str_danmaku_decay, &danmaku_decay),
+        CFG_SIMPLE_BOOL(str_adaptive_lifetime, &adaptive_lifetime),
+        CFG_SIMPLE_FLOAT(str_danmaku_min_lifetime, &danmaku_min_lifetime),
+        CFG_SIMPLE_INT(str_max_danmaku_lines, &max_danmaku_lines),
         CFG_SIMPLE_INT(str_max_fps, &max_fps),
+        CFG_SIMPLE_BOOL(str_adaptive_quality, &adaptive_quality),
+        CFG_SIMPLE_INT(str_render_threads, &render_threads),
+        CFG_SIMPLE_INT(str_tile_cache_size, &tile_cache_size),
+        CFG_SIMPLE_STR(str_frame_ring, &frame_ring),
+        CFG_SIMPLE_INT(str_frame_ring_slots, &frame_ring_slots),
+        CFG_SIMPLE_STR(str_video_output, &video_output),
+        CFG_SIMPLE_STR(str_video_format, &video_format),
+        CFG_SIMPLE_INT(str_video_fps, &video_fps),
+        CFG_SIMPLE_INT(str_video_queue_frames, &video_queue_frames),
+        CFG_SIMPLE_STR(str_offline_timeline, &offline_timeline),
+        CFG_SIMPLE_INT(str_offline_stage_height, &offline_stage_height),
+        CFG_SIMPLE_FLOAT(str_clock_step, &clock_step),
+        CFG_STR_LIST(str_input_sources, str_input_sources_default, CFGF_NONE),
+        CFG_SIMPLE_INT(str_input_backlog, &input_backlog),
+        CFG_SIMPLE_STR(str_input_format, &input_format),
+        CFG_SIMPLE_STR(str_ingest_socket, &ingest_socket),
+        CFG_SIMPLE_INT(str_ingest_tcp_port, &ingest_tcp_port),
         CFG_END()
     };
     cfg_t *cfg = cfg_init(opts, 0);
     int parse_result = cfg_parse(cfg, config_filename);
+    std::vector<std::string> fallback_font_files;
+    if(parse_result == CFG_SUCCESS)
+        for(unsigned int i = 0; i < cfg_size(cfg, str_fallback_font_files); i++)
+            fallback_font_files.push_back(cfg_getnstr(cfg, str_fallback_font_files, i));
+    std::vector<std::string> input_sources;
+    if(parse_result == CFG_SUCCESS)
+        for(unsigned int i = 0; i < cfg_size(cfg, str_input_sources); i++)
+            input_sources.push_back(cfg_getnstr(cfg, str_input_sources, i));
     cfg_free(cfg);
 
     dmhm_assert(parse_result != CFG_FILE_ERROR);
@@ -73,23 +166,96 @@ int load_config(const char *config_filename) {
     dmhm_assert(font_file != nullptr);
     dmhm_assert(*font_file != '\0');
     dmhm_assert(font_file_index >= 0);
+    for(const std::string &i : fallback_font_files)
+        dmhm_assert(!i.empty());
     dmhm_assert(font_size >= 0);
     dmhm_assert(shadow_radius >= 0 && shadow_radius <= stage_width);
+    dmhm_assert(shadow_engine != nullptr);
+    dmhm_assert(is_valid_shadow_engine(shadow_engine));
+    dmhm_assert(shadow_downsample == 1 || shadow_downsample == 2 || shadow_downsample == 4);
+    dmhm_assert(glyph_cache_file != nullptr);
+    dmhm_assert(glyph_cache_charset != nullptr);
     dmhm_assert(danmaku_lifetime > 0);
     dmhm_assert(danmaku_attack >= 0);
     dmhm_assert(danmaku_decay >= 0);
     dmhm_assert(danmaku_attack + danmaku_decay <= danmaku_lifetime);
+    /* Only enforced when asked for, older configs that shorten danmaku_lifetime still load */
+    if(std::isnan(danmaku_min_lifetime))
+        danmaku_min_lifetime = std::max(danmaku_attack + danmaku_decay, std::min(config::danmaku_min_lifetime, danmaku_lifetime));
+    else if(adaptive_lifetime != cfg_false)
+        dmhm_assert(danmaku_attack + danmaku_decay <= danmaku_min_lifetime && danmaku_min_lifetime <= danmaku_lifetime);
+    else if(danmaku_min_lifetime < danmaku_attack + danmaku_decay || danmaku_min_lifetime > danmaku_lifetime) {
+        double clamped = std::max(danmaku_attack + danmaku_decay, std::min(danmaku_min_lifetime, danmaku_lifetime));
+        std::cerr << "danmaku_min_lifetime " << danmaku_min_lifetime << " is outside [danmaku_attack + danmaku_decay, danmaku_lifetime], using " << clamped << std::endl;
+        danmaku_min_lifetime = clamped;
+    }
+    dmhm_assert(max_danmaku_lines >= 0);
+    dmhm_assert(max_fps > 0 && max_fps <= 1000);
+    dmhm_assert(render_threads >= 0 && render_threads <= 64);
+    dmhm_assert(tile_cache_size >= 0);
+    dmhm_assert(frame_ring != nullptr);
+    /* A POSIX shared memory name, such as "/live_danmaku_hime" */
+    dmhm_assert(*frame_ring == '\0' || (frame_ring[0] == '/' && frame_ring[1] != '\0' && std::strchr(frame_ring+1, '/') == nullptr));
+    dmhm_assert(frame_ring_slots >= 2 && frame_ring_slots <= 64);
+    dmhm_assert(video_output != nullptr);
+    dmhm_assert(video_format != nullptr);
+    dmhm_assert(is_valid_video_format(video_format));
+    dmhm_assert(video_fps >= 0 && video_fps <= 1000);
+    dmhm_assert(video_queue_frames > 0 && video_queue_frames <= 256);
+    dmhm_assert(offline_timeline != nullptr);
+    /* Offline rendering has nowhere to go but video_output */
+    dmhm_assert(*offline_timeline == '\0' || *video_output != '\0');
+    dmhm_assert(offline_stage_height > 0 && offline_stage_height <= 16384);
+    dmhm_assert(clock_step >= 0 && clock_step <= 3600);
+    for(const std::string &i : input_sources)
+        dmhm_assert(!i.empty());
+    dmhm_assert(input_backlog >= 1 && input_backlog <= 1000000);
+    dmhm_assert(input_format != nullptr);
+    dmhm_assert(is_valid_input_format(input_format));
+    dmhm_assert(ingest_socket != nullptr);
+    dmhm_assert(std::strlen(ingest_socket) < 108);
+    dmhm_assert(ingest_tcp_port >= 0 && ingest_tcp_port <= 65535);
+#ifndef __linux__
+    /* Other systems read stdin alone */
+    dmhm_assert(input_sources.size() == 1 && input_sources[0] == "-");
+    dmhm_assert(*ingest_socket == '\0' && ingest_tcp_port == 0);
+#endif
 
     config::stage_width = stage_width;
     config::extra_line_height = extra_line_height;
     config::font_file = font_file;
     config::font_file_index = font_file_index;
+    config::fallback_font_files = std::move(fallback_font_files);
     config::font_size = font_size;
     config::shadow_radius = shadow_radius;
+    config::shadow_engine = shadow_engine;
+    config::shadow_downsample = shadow_downsample;
+    config::glyph_cache_file = glyph_cache_file;
+    config::glyph_cache_charset = glyph_cache_charset;
     config::danmaku_lifetime = danmaku_lifetime;
     config::danmaku_attack = danmaku_attack;
     config::danmaku_decay = danmaku_decay;
+    config::adaptive_lifetime = adaptive_lifetime != cfg_false;
+    config::danmaku_min_lifetime = danmaku_min_lifetime;
+    config::max_danmaku_lines = max_danmaku_lines;
     config::max_fps = max_fps;
+    config::adaptive_quality = adaptive_quality != cfg_false;
+    config::render_threads = render_threads;
+    config::tile_cache_size = tile_cache_size;
+    config::frame_ring = frame_ring;
+    config::frame_ring_slots = frame_ring_slots;
+    config::video_output = video_output;
+    config::video_format = video_format;
+    config::video_fps = video_fps;
+    config::video_queue_frames = video_queue_frames;
+    config::offline_timeline = offline_timeline;
+    config::offline_stage_height = offline_stage_height;
+    config::clock_step = clock_step;
+    config::input_sources = std::move(input_sources);
+    config::input_backlog = input_backlog;
+    config::input_format = input_format;
+    config::ingest_socket = ingest_socket;
+    config::ingest_tcp_port = ingest_tcp_port;
 
     return parse_result;
 }
@@ -0,0 +1,144 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "mapped_file.h"
+#include "utils.h"
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dmhm {
+
+struct MappedFilePrivate {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping_handle = nullptr;
+#endif
+};
+
+MappedFile::MappedFile() {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char *filename) {
+    close();
+    p->file_handle = CreateFileW(utf8_to_wide(filename).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(p->file_handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(p->file_handle, &file_size) || file_size.QuadPart == 0 || uint64_t(file_size.QuadPart) > SIZE_MAX) {
+        close();
+        return false;
+    }
+    p->mapping_handle = CreateFileMappingW(p->file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!p->mapping_handle) {
+        close();
+        return false;
+    }
+    p->data = reinterpret_cast<const uint8_t *>(MapViewOfFile(p->mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if(!p->data) {
+        close();
+        return false;
+    }
+    p->size = size_t(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if(p->data) {
+        UnmapViewOfFile(p->data);
+        p->data = nullptr;
+    }
+    p->size = 0;
+    if(p->mapping_handle) {
+        CloseHandle(p->mapping_handle);
+        p->mapping_handle = nullptr;
+    }
+    if(p->file_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(p->file_handle);
+        p->file_handle = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool replace_file(const char *src, const char *dst) {
+    return MoveFileExW(utf8_to_wide(src).c_str(), utf8_to_wide(dst).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+#else
+
+bool MappedFile::open(const char *filename) {
+    close();
+    int fd = ::open(filename, O_RDONLY);
+    if(fd == -1)
+        return false;
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, size_t(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    /* The mapping keeps its own reference to the file */
+    ::close(fd);
+    if(data == MAP_FAILED)
+        return false;
+    p->data = reinterpret_cast<const uint8_t *>(data);
+    p->size = size_t(file_stat.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if(p->data) {
+        munmap(const_cast<uint8_t *>(p->data), p->size);
+        p->data = nullptr;
+    }
+    p->size = 0;
+}
+
+bool replace_file(const char *src, const char *dst) {
+    return std::rename(src, dst) == 0;
+}
+
+#endif
+
+bool MappedFile::is_open() const {
+    return p->data != nullptr;
+}
+
+const uint8_t *MappedFile::data() const {
+    return p->data;
+}
+
+size_t MappedFile::size() const {
+    return p->size;
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+#include "utils.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace dmhm {
+
+/* A read-only memory mapping of a whole file */
+class MappedFile {
+
+public:
+
+    MappedFile();
+    ~MappedFile();
+    bool open(const char *filename);
+    void close();
+    bool is_open() const;
+    const uint8_t *data() const;
+    size_t size() const;
+
+private:
+
+    proxy_ptr<struct MappedFilePrivate> p;
+
+};
+
+/* Atomically replace dst with src, used to publish cache files */
+bool replace_file(const char *src, const char *dst);
+
+}
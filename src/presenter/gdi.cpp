@@ -45,7 +45,7 @@ struct GDIPresenterPrivate {
     int32_t top; int32_t left; int32_t right; int32_t bottom;
     void get_stage_rect(GDIPresenter *pub);
     void create_buffer(GDIPresenter *pub);
-    void do_paint(GDIPresenter *pub, const uint32_t *bitmap, uint32_t width, uint32_t height, uint32_t stride);
+    void do_paint(GDIPresenter *pub, const uint32_t *bitmap, uint32_t width, uint32_t height, uint32_t stride, uint32_t band_top, uint32_t band_height);
 };
 
 GDIPresenter::GDIPresenter(Application *app) {
@@ -151,8 +151,8 @@ void GDIPresenter::paint_frame() {
 
     Renderer *renderer = reinterpret_cast<Renderer *>(p->app->get_renderer());
     dmhm_assert(renderer);
-    if(!renderer->paint_frame(width, height, [&](const uint32_t *bitmap, uint32_t stride) {
-        p->do_paint(this, bitmap, width, height, stride);
+    if(!renderer->paint_frame(width, height, [&](const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+        p->do_paint(this, bitmap, width, height, stride, band_top, band_height);
     }))
         PostQuitMessage(0);
 }
@@ -241,8 +241,9 @@ void GDIPresenterPrivate::create_buffer(GDIPresenter *pub) {
     SelectObject(buffer_dc, dib_handle);
 }
 
-void GDIPresenterPrivate::do_paint(GDIPresenter *pub, const uint32_t *bitmap, uint32_t width, uint32_t height, uint32_t stride) {
-    for(uint32_t i = 0; i < height; i++)
+/* Only the band is copied, and the layered window is shrunk to it */
+void GDIPresenterPrivate::do_paint(GDIPresenter *pub, const uint32_t *bitmap, uint32_t width, uint32_t height, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+    for(uint32_t i = band_top; i < band_top+band_height; i++)
         for(uint32_t j = 0; j < width; j++) {
             /*
             uint8_t alpha = uint8_t(bitmap[i*stride + j] >> 24);
@@ -256,13 +257,13 @@ void GDIPresenterPrivate::do_paint(GDIPresenter *pub, const uint32_t *bitmap, ui
 
     POINT window_pos;
     window_pos.x = left;
-    window_pos.y = top;
+    window_pos.y = top+band_top;
     SIZE window_size;
     window_size.cx = right-left;
-    window_size.cy = bottom-top;
+    window_size.cy = band_height;
     POINT buffer_pos;
     buffer_pos.x = 0;
-    buffer_pos.y = 0;
+    buffer_pos.y = band_top;
     BLENDFUNCTION blend_function;
     blend_function.BlendOp = AC_SRC_OVER;
     blend_function.BlendFlags = 0;
@@ -22,7 +22,10 @@
 #include "../app.h"
 #include "../renderer/renderer.h"
 #include "../config.h"
+#include "present_latency.h"
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <gtkmm.h>
@@ -46,8 +49,17 @@ struct GtkPresenterPrivate {
     Glib::RefPtr<Gtk::Application> gtkapp;
     std::unique_ptr<Window> window;
     int32_t top; int32_t left; int32_t right; int32_t bottom;
+    /* The window only covers the rows of the stage that the renderer uses */
+    uint32_t band_top = 0; uint32_t band_height = 0;
+    /* From queueing a draw until GDK has painted it, comparable to the X11 presenter */
+    std::chrono::steady_clock::time_point request_time;
+    bool draw_pending = false;
+    bool drawn = false;
+    PresentLatency latency;
+    static void on_after_paint(GdkFrameClock *frame_clock, gpointer user_data);
     void get_stage_rect(GtkPresenter *pub);
     void do_paint(GtkPresenter *pub, const Cairo::RefPtr<Cairo::Context> &cr, const uint32_t *bitmap, uint32_t width, uint32_t height, uint32_t stride);
+    void resize_band(GtkPresenter *pub, uint32_t new_band_top, uint32_t new_band_height);
 };
 
 GtkPresenter::GtkPresenter(Application *app) {
@@ -68,6 +80,7 @@ GtkPresenter::GtkPresenter(Application *app) {
     p->window->move(p->left, p->top);
     uint32_t width, height;
     get_stage_size(width, height);
+    p->band_height = height;
     p->window->set_size_request(width, height);
     p->window->stick();
 
@@ -82,12 +95,16 @@ GtkPresenter::GtkPresenter(Application *app) {
     gtk_widget_set_visual(GTK_WIDGET(p->window->gobj()), visual->gobj());
 
     p->window->show();
+    /* The frame clock exists once the window is realized */
+    GdkFrameClock *frame_clock = gtk_widget_get_frame_clock(GTK_WIDGET(p->window->gobj()));
+    if(frame_clock)
+        g_signal_connect(frame_clock, "after-paint", G_CALLBACK(GtkPresenterPrivate::on_after_paint), p.get());
     Glib::signal_timeout().connect([&]() -> bool {
         paint_frame();
         return true;
     }, 1000/config::max_fps);
     Glib::signal_timeout().connect([&]() -> bool {
-        p->window->move(p->left, p->top);
+        p->window->move(p->left, p->top+p->band_top);
         return true;
     }, 1000);
 }
@@ -113,6 +130,12 @@ void GtkPresenter::get_stage_size(uint32_t &width, uint32_t &height) {
 }
 
 void GtkPresenter::paint_frame() {
+    if(p->draw_pending)
+        p->latency.count_skipped();
+    else {
+        p->request_time = std::chrono::steady_clock::now();
+        p->draw_pending = true;
+    }
     p->window->queue_draw();
 }
 
@@ -136,6 +159,9 @@ void GtkPresenterPrivate::get_stage_rect(GtkPresenter *pub) {
 }
 
 void GtkPresenterPrivate::do_paint(GtkPresenter *pub, const Cairo::RefPtr<Cairo::Context> &cr, const uint32_t *bitmap, uint32_t width, uint32_t height, uint32_t stride) {
+    /* Painted from the band of this frame, resize_band has already moved the window to it */
+    bitmap += band_top*stride;
+    height = std::min(height-band_top, band_height);
     Cairo::RefPtr<Cairo::ImageSurface> surface = Cairo::ImageSurface::create(reinterpret_cast<unsigned char *>(const_cast<uint32_t *>(bitmap)), Cairo::FORMAT_ARGB32, width, height, stride*sizeof (uint32_t));
     cr->set_source(surface, 0, 0);
     cr->move_to(0, 0);
@@ -143,6 +169,28 @@ void GtkPresenterPrivate::do_paint(GtkPresenter *pub, const Cairo::RefPtr<Cairo:
     cr->paint();
 }
 
+void GtkPresenterPrivate::resize_band(GtkPresenter *pub, uint32_t new_band_top, uint32_t new_band_height) {
+    if(new_band_top == band_top && new_band_height == band_height)
+        return;
+    band_top = new_band_top;
+    band_height = new_band_height;
+    uint32_t width, height;
+    pub->get_stage_size(width, height);
+    window->set_size_request(width, band_height);
+    window->resize(width, band_height);
+    window->move(left, top+band_top);
+}
+
+void GtkPresenterPrivate::on_after_paint(GdkFrameClock *, gpointer user_data) {
+    GtkPresenterPrivate *self = static_cast<GtkPresenterPrivate *>(user_data);
+    if(!self->drawn || !self->draw_pending)
+        return;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    self->latency.count_presented(now-self->request_time, now);
+    self->drawn = false;
+    self->draw_pending = false;
+}
+
 bool GtkPresenterPrivate::Window::on_draw(const Cairo::RefPtr<Cairo::Context> &cr) {
     Gtk::Window::on_draw(cr);
 
@@ -154,7 +202,9 @@ bool GtkPresenterPrivate::Window::on_draw(const Cairo::RefPtr<Cairo::Context> &c
 
     Renderer *renderer = reinterpret_cast<Renderer *>(pub->p->app->get_renderer());
     dmhm_assert(renderer);
-    if(!renderer->paint_frame(width, height, [&](const uint32_t *bitmap, uint32_t stride) {
+    pub->p->drawn = true;
+    if(!renderer->paint_frame(width, height, [&](const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+        pub->p->resize_band(pub, band_top, band_height);
         pub->p->do_paint(pub, cr, bitmap, width, height, stride);
     }))
         pub->p->gtkapp->quit();
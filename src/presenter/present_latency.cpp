@@ -0,0 +1,70 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "present_latency.h"
+#include "../utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+namespace dmhm {
+
+struct PresentLatencyPrivate {
+    std::chrono::steady_clock::time_point checkpoint;
+    std::chrono::steady_clock::duration total = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::duration max = std::chrono::steady_clock::duration::zero();
+    uint32_t presented_frames = 0;
+    uint32_t skipped_frames = 0;
+    void print_stats();
+};
+
+PresentLatency::PresentLatency() {
+    p->checkpoint = std::chrono::steady_clock::now();
+}
+
+PresentLatency::~PresentLatency() {
+    if(p->presented_frames != 0)
+        p->print_stats();
+}
+
+void PresentLatency::count_presented(std::chrono::steady_clock::duration latency, std::chrono::steady_clock::time_point now) {
+    p->total += latency;
+    p->max = std::max(p->max, latency);
+    p->presented_frames++;
+    if(now-p->checkpoint > std::chrono::seconds(10)) {
+        p->print_stats();
+        p->checkpoint = now;
+    }
+}
+
+void PresentLatency::count_skipped() {
+    p->skipped_frames++;
+}
+
+void PresentLatencyPrivate::print_stats() {
+    typedef std::chrono::duration<double, std::milli> milliseconds;
+    std::cerr << "Present latency: " << milliseconds(total).count()/presented_frames << " ms average, " << milliseconds(max).count() << " ms max, "
+        << presented_frames << " frames presented, " << skipped_frames << " frames skipped" << std::endl;
+    total = max = std::chrono::steady_clock::duration::zero();
+    presented_frames = 0;
+    skipped_frames = 0;
+}
+
+}
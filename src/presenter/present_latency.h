@@ -0,0 +1,47 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include <chrono>
+#include <cstdint>
+
+namespace dmhm {
+
+/* Time from the presenter asking for a frame until the display server has it,
+   the same measure for every presenter so they can be compared.
+   Printed every ten seconds and once more when destroyed */
+class PresentLatency {
+
+public:
+
+    PresentLatency();
+    ~PresentLatency();
+    void count_presented(std::chrono::steady_clock::duration latency, std::chrono::steady_clock::time_point now);
+    /* A frame not asked for because the last one was still on its way */
+    void count_skipped();
+
+private:
+
+    proxy_ptr<struct PresentLatencyPrivate> p;
+
+};
+
+}
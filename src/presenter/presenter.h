@@ -18,8 +18,10 @@
 */
 
 #pragma once
-#ifdef USE_GDI_PRESENTER
+#if defined(USE_GDI_PRESENTER)
 #include "gdi.h"
+#elif defined(USE_X11_PRESENTER)
+#include "x11.h"
 #else
 #include "gtk.h"
 #endif
@@ -28,8 +30,10 @@ namespace dmhm {
 
 struct BasePresenter; // Opaque type
 
-#ifdef USE_GDI_PRESENTER
+#if defined(USE_GDI_PRESENTER)
 typedef GDIPresenter Presenter;
+#elif defined(USE_X11_PRESENTER)
+typedef X11Presenter Presenter;
 #else
 typedef GtkPresenter Presenter;
 #endif
@@ -0,0 +1,399 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "x11.h"
+#include "../utils.h"
+#include "../app.h"
+#include "../renderer/renderer.h"
+#include "../config.h"
+#include "present_latency.h"
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <poll.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/shape.h>
+
+namespace dmhm {
+
+struct X11PresenterPrivate {
+    Application *app = nullptr;
+    Display *display = nullptr;
+    int screen = 0;
+    Visual *visual = nullptr;
+    Colormap colormap = 0;
+    Window window = 0;
+    GC gc = nullptr;
+    int32_t top; int32_t left; int32_t right; int32_t bottom;
+    /* The window only covers the rows of the stage that the renderer uses */
+    uint32_t band_top = 0; uint32_t band_height = 0;
+
+    /* The renderer paints into the image, in shared memory with the X server if possible */
+    XImage *image = nullptr;
+    XShmSegmentInfo shm_info;
+    bool use_shm = false;
+    int shm_completion_event = 0;
+    bool put_pending = false; // The server may still be reading the image
+    bool quitting = false;
+
+    /* From asking the renderer for a frame until the server is done reading it */
+    std::chrono::steady_clock::time_point request_time;
+    PresentLatency latency;
+
+    void get_stage_rect(X11Presenter *pub);
+    void create_window(X11Presenter *pub);
+    void create_image(X11Presenter *pub);
+    void release_image();
+    void set_wm_state();
+    void do_paint(X11Presenter *pub, uint32_t width, uint32_t band_top, uint32_t band_height);
+    void resize_band(X11Presenter *pub, uint32_t new_band_top, uint32_t new_band_height);
+    void handle_event(X11Presenter *pub, XEvent &event);
+};
+
+X11Presenter::X11Presenter(Application *app) {
+    p->app = app;
+    p->display = XOpenDisplay(nullptr);
+    if(!p->display) {
+        /* Failed to connect to the X server */
+        report_error("\xe6\x97\xa0\xe6\xb3\x95\xe8\xbf\x9e\xe6\x8e\xa5\xe5\x88\xb0\x20\x58\x20\xe6\x9c\x8d\xe5\x8a\xa1\xe5\x99\xa8");
+        abort();
+    }
+    p->screen = DefaultScreen(p->display);
+    p->get_stage_rect(this);
+    p->create_window(this);
+    p->create_image(this);
+}
+
+X11Presenter::~X11Presenter() {
+    Renderer *renderer = reinterpret_cast<Renderer *>(p->app->get_renderer());
+    if(renderer)
+        renderer->set_frame_buffer(nullptr, 0);
+    p->release_image();
+    if(p->gc)
+        XFreeGC(p->display, p->gc);
+    if(p->window)
+        XDestroyWindow(p->display, p->window);
+    if(p->colormap)
+        XFreeColormap(p->display, p->colormap);
+    if(p->display)
+        XCloseDisplay(p->display);
+}
+
+/* There is no toolkit to show a dialog with */
+void X11Presenter::report_error(const std::string error) {
+    std::cerr << error << std::endl;
+}
+
+void X11Presenter::get_stage_size(uint32_t &width, uint32_t &height) {
+    dmhm_assert(p->right >= p->left && p->bottom >= p->top);
+    width = p->right - p->left;
+    height = p->bottom - p->top;
+}
+
+/* Skipped while the server still reads the last frame, the animation goes by the clock anyway */
+void X11Presenter::paint_frame() {
+    if(p->put_pending) {
+        p->latency.count_skipped();
+        return;
+    }
+    p->request_time = std::chrono::steady_clock::now();
+    uint32_t width, height;
+    get_stage_size(width, height);
+
+    Renderer *renderer = reinterpret_cast<Renderer *>(p->app->get_renderer());
+    dmhm_assert(renderer);
+    if(!renderer->paint_frame(width, height, [&](const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+        dmhm_assert(bitmap == reinterpret_cast<const uint32_t *>(p->image->data));
+        p->resize_band(this, band_top, band_height);
+        p->do_paint(this, width, band_top, band_height);
+    }))
+        p->quitting = true;
+}
+
+int X11Presenter::run_loop() {
+    Renderer *renderer = reinterpret_cast<Renderer *>(p->app->get_renderer());
+    dmhm_assert(renderer);
+    renderer->set_frame_buffer(reinterpret_cast<uint32_t *>(p->image->data), uint32_t(p->image->bytes_per_line/sizeof (uint32_t)));
+
+    std::chrono::steady_clock::duration frame_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1))/config::max_fps;
+    std::chrono::steady_clock::time_point next_frame = std::chrono::steady_clock::now();
+    while(!p->quitting) {
+        while(XPending(p->display)) {
+            XEvent event;
+            XNextEvent(p->display, &event);
+            p->handle_event(this, event);
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(now >= next_frame) {
+            paint_frame();
+            /* A late frame does not make the next ones come sooner */
+            next_frame = std::max(next_frame+frame_interval, now);
+            continue;
+        }
+        struct pollfd fd = { ConnectionNumber(p->display), POLLIN, 0 };
+        int timeout = int(std::chrono::duration_cast<std::chrono::milliseconds>(next_frame-now).count())+1;
+        poll(&fd, 1, timeout);
+    }
+    return 0;
+}
+
+void X11PresenterPrivate::get_stage_rect(X11Presenter *pub) {
+    Window root = RootWindow(display, screen);
+    int32_t area_left = 0, area_top = 0;
+    int32_t area_width = DisplayWidth(display, screen), area_height = DisplayHeight(display, screen);
+    /* The work area excludes panels, if the window manager tells it */
+    Atom workarea = XInternAtom(display, "_NET_WORKAREA", True);
+    if(workarea != None) {
+        Atom type;
+        int format;
+        unsigned long count, remaining;
+        unsigned char *data = nullptr;
+        if(XGetWindowProperty(display, root, workarea, 0, 4, False, XA_CARDINAL, &type, &format, &count, &remaining, &data) == Success && data) {
+            if(type == XA_CARDINAL && format == 32 && count >= 4) {
+                const long *values = reinterpret_cast<const long *>(data);
+                area_left = int32_t(values[0]);
+                area_top = int32_t(values[1]);
+                area_width = int32_t(values[2]);
+                area_height = int32_t(values[3]);
+            }
+            XFree(data);
+        }
+    }
+    if(area_width <= 0 || area_height <= 0) {
+        /* Failed to retrieve screen size */
+        pub->report_error("\xe8\x8e\xb7\xe5\x8f\x96\xe5\xb1\x8f\xe5\xb9\x95\xe5\xb0\xba\xe5\xaf\xb8\xe5\xa4\xb1\xe8\xb4\xa5");
+        abort();
+    }
+    top = area_top;
+    left = area_left + area_width - config::stage_width;
+    right = area_left + area_width;
+    bottom = area_top + area_height;
+}
+
+void X11PresenterPrivate::create_window(X11Presenter *pub) {
+    XVisualInfo visual_info;
+    if(!XMatchVisualInfo(display, screen, 32, TrueColor, &visual_info)) {
+        /* Desktop compositor failed to set window transparency */
+        pub->report_error("\xe6\xa1\x8c\xe9\x9d\xa2\xe6\xb7\xb7\xe6\x88\x90\xe5\x99\xa8\xe6\x97\xa0\xe6\xb3\x95\xe8\xae\xbe\xe7\xbd\xae\xe9\x80\x8f\xe6\x98\x8e\xe7\xaa\x97\xe5\x8f\xa3");
+        abort();
+    }
+    visual = visual_info.visual;
+    Window root = RootWindow(display, screen);
+    colormap = XCreateColormap(display, root, visual, AllocNone);
+
+    uint32_t width, height;
+    pub->get_stage_size(width, height);
+    band_height = height;
+    XSetWindowAttributes attributes;
+    attributes.colormap = colormap;
+    attributes.background_pixel = 0;
+    attributes.border_pixel = 0;
+    attributes.event_mask = ExposureMask | StructureNotifyMask;
+    window = XCreateWindow(display, root, left, top, width, height, 0, 32, InputOutput, visual, CWColormap | CWBackPixel | CWBorderPixel | CWEventMask, &attributes);
+    gc = XCreateGC(display, window, 0, nullptr);
+
+    XStoreName(display, window, "\xe5\xbc\xb9\xe5\xb9\x95\xe5\xa7\xac");
+    Atom net_wm_name = XInternAtom(display, "_NET_WM_NAME", False);
+    Atom utf8_string = XInternAtom(display, "UTF8_STRING", False);
+    const char title[] = "\xe5\xbc\xb9\xe5\xb9\x95\xe5\xa7\xac";
+    XChangeProperty(display, window, net_wm_name, utf8_string, 8, PropModeReplace, reinterpret_cast<const unsigned char *>(title), sizeof title - 1);
+    /* Never takes focus */
+    XWMHints wm_hints;
+    wm_hints.flags = InputHint;
+    wm_hints.input = False;
+    XSetWMHints(display, window, &wm_hints);
+    /* Placed where asked, at a fixed size */
+    XSizeHints size_hints;
+    size_hints.flags = PPosition | PMinSize | PMaxSize;
+    size_hints.x = left;
+    size_hints.y = top;
+    size_hints.min_width = size_hints.max_width = int(width);
+    size_hints.min_height = size_hints.max_height = int(height);
+    XSetWMNormalHints(display, window, &size_hints);
+    set_wm_state();
+    /* Clicks go through to the windows below, except for one pixel */
+    XRectangle click_rect = { 0, 0, 1, 1 };
+    XShapeCombineRectangles(display, window, ShapeInput, 0, 0, &click_rect, 1, ShapeSet, Unsorted);
+
+    XMapWindow(display, window);
+    XMoveWindow(display, window, left, top);
+    XFlush(display);
+}
+
+/* Undecorated, above other windows, on all desktops, and out of the taskbar and pager */
+void X11PresenterPrivate::set_wm_state() {
+    struct {
+        unsigned long flags, functions, decorations;
+        long input_mode;
+        unsigned long status;
+    } motif_hints = { 2, 0, 0, 0, 0 }; // MWM_HINTS_DECORATIONS, none
+    Atom motif_wm_hints = XInternAtom(display, "_MOTIF_WM_HINTS", False);
+    XChangeProperty(display, window, motif_wm_hints, motif_wm_hints, 32, PropModeReplace, reinterpret_cast<const unsigned char *>(&motif_hints), 5);
+
+    Atom states[] = {
+        XInternAtom(display, "_NET_WM_STATE_ABOVE", False),
+        XInternAtom(display, "_NET_WM_STATE_STICKY", False),
+        XInternAtom(display, "_NET_WM_STATE_SKIP_TASKBAR", False),
+        XInternAtom(display, "_NET_WM_STATE_SKIP_PAGER", False)
+    };
+    Atom net_wm_state = XInternAtom(display, "_NET_WM_STATE", False);
+    XChangeProperty(display, window, net_wm_state, XA_ATOM, 32, PropModeReplace, reinterpret_cast<const unsigned char *>(states), sizeof states / sizeof states[0]);
+    unsigned long all_desktops = 0xffffffff;
+    Atom net_wm_desktop = XInternAtom(display, "_NET_WM_DESKTOP", False);
+    XChangeProperty(display, window, net_wm_desktop, XA_CARDINAL, 32, PropModeReplace, reinterpret_cast<const unsigned char *>(&all_desktops), 1);
+}
+
+/* Set by the error handler while XShmAttach is tried */
+static bool shm_attach_failed = false;
+
+static int on_shm_attach_error(Display *, XErrorEvent *) {
+    shm_attach_failed = true;
+    return 0;
+}
+
+/* A remote server may offer MIT-SHM and only refuse the attach later with BadAccess,
+   which would kill the process under the default error handler */
+static bool try_shm_attach(Display *display, XShmSegmentInfo *shm_info) {
+    XSync(display, False);
+    shm_attach_failed = false;
+    XErrorHandler old_handler = XSetErrorHandler(on_shm_attach_error);
+    bool attached = XShmAttach(display, shm_info);
+    XSync(display, False);
+    if(attached && shm_attach_failed) {
+        XShmDetach(display, shm_info);
+        XSync(display, False);
+        attached = false;
+    }
+    XSetErrorHandler(old_handler);
+    return attached;
+}
+
+/* A whole stage, falls back to a plain image copied over the socket when the server is not local */
+void X11PresenterPrivate::create_image(X11Presenter *pub) {
+    uint32_t width, height;
+    pub->get_stage_size(width, height);
+    use_shm = XShmQueryExtension(display);
+    if(use_shm) {
+        image = XShmCreateImage(display, visual, 32, ZPixmap, nullptr, &shm_info, width, height);
+        if(image) {
+            shm_info.shmid = shmget(IPC_PRIVATE, size_t(image->bytes_per_line)*image->height, IPC_CREAT | 0600);
+            shm_info.shmaddr = shm_info.shmid < 0 ? reinterpret_cast<char *>(-1) : reinterpret_cast<char *>(shmat(shm_info.shmid, nullptr, 0));
+            shm_info.readOnly = True;
+            if(shm_info.shmaddr != reinterpret_cast<char *>(-1) && try_shm_attach(display, &shm_info)) {
+                image->data = shm_info.shmaddr;
+                /* Freed once both sides detach, even if the process dies */
+                shmctl(shm_info.shmid, IPC_RMID, nullptr);
+                shm_completion_event = XShmGetEventBase(display) + ShmCompletion;
+            } else {
+                if(shm_info.shmaddr != reinterpret_cast<char *>(-1))
+                    shmdt(shm_info.shmaddr);
+                if(shm_info.shmid >= 0)
+                    shmctl(shm_info.shmid, IPC_RMID, nullptr);
+                XDestroyImage(image);
+                image = nullptr;
+                use_shm = false;
+            }
+        } else
+            use_shm = false;
+    }
+    if(!use_shm) {
+        std::cerr << "MIT-SHM is not available, frames are copied to the X server" << std::endl;
+        char *data = reinterpret_cast<char *>(std::calloc(size_t(width)*height, sizeof (uint32_t)));
+        image = data ? XCreateImage(display, visual, 32, ZPixmap, 0, data, width, height, 32, 0) : nullptr;
+    }
+    if(!image || image->bits_per_pixel != 32 || image->bytes_per_line % sizeof (uint32_t) != 0) {
+        /* Failed to create buffer */
+        pub->report_error("\xe5\x88\x9b\xe5\xbb\xba\xe7\xbc\x93\xe5\x86\xb2\xe5\x8c\xba\xe5\xa4\xb1\xe8\xb4\xa5");
+        abort();
+    }
+}
+
+void X11PresenterPrivate::release_image() {
+    if(!image)
+        return;
+    if(use_shm) {
+        XShmDetach(display, &shm_info);
+        XSync(display, False);
+        shmdt(shm_info.shmaddr);
+        image->data = nullptr;
+    }
+    XDestroyImage(image);
+    image = nullptr;
+}
+
+/* Only the band is sent, the window is shrunk to it */
+void X11PresenterPrivate::do_paint(X11Presenter *pub, uint32_t width, uint32_t band_top, uint32_t band_height) {
+    if(use_shm) {
+        XShmPutImage(display, window, gc, image, 0, band_top, 0, 0, width, band_height, True);
+        put_pending = true;
+    } else {
+        XPutImage(display, window, gc, image, 0, band_top, 0, 0, width, band_height);
+        XSync(display, False);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        latency.count_presented(now-request_time, now);
+    }
+    XFlush(display);
+}
+
+void X11PresenterPrivate::resize_band(X11Presenter *pub, uint32_t new_band_top, uint32_t new_band_height) {
+    if(new_band_top == band_top && new_band_height == band_height)
+        return;
+    band_top = new_band_top;
+    band_height = new_band_height;
+    uint32_t width, height;
+    pub->get_stage_size(width, height);
+    XSizeHints size_hints;
+    size_hints.flags = PPosition | PMinSize | PMaxSize;
+    size_hints.x = left;
+    size_hints.y = top+band_top;
+    size_hints.min_width = size_hints.max_width = int(width);
+    size_hints.min_height = size_hints.max_height = int(band_height);
+    XSetWMNormalHints(display, window, &size_hints);
+    XMoveResizeWindow(display, window, left, top+band_top, width, band_height);
+}
+
+void X11PresenterPrivate::handle_event(X11Presenter *pub, XEvent &event) {
+    if(use_shm && event.type == shm_completion_event) {
+        put_pending = false;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        latency.count_presented(now-request_time, now);
+        return;
+    }
+    switch(event.type) {
+    case Expose:
+        /* The image still holds the last frame */
+        if(event.xexpose.count == 0 && !put_pending) {
+            uint32_t width, height;
+            pub->get_stage_size(width, height);
+            request_time = std::chrono::steady_clock::now();
+            do_paint(pub, width, band_top, std::min(band_height, height-band_top));
+        }
+        break;
+    case DestroyNotify:
+        quitting = true;
+        break;
+    }
+}
+
+}
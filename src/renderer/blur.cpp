@@ -0,0 +1,415 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "blur.h"
+#include "../utils.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+namespace dmhm {
+
+static void box_blur(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r);
+static void box_blur_H(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r);
+static void box_blur_T(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r);
+static void dilate_H(const uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r, uint32_t *workspace);
+static void dilate_T(const uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r, uint32_t *workspace);
+static void smooth_3x3(const uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, uint32_t *workspace);
+
+static const struct {
+    const char *name;
+    ShadowEngine engine;
+} shadow_engine_names[] = {
+    {"box", SHADOW_ENGINE_BOX},
+    {"iir", SHADOW_ENGINE_IIR},
+    {"stamp", SHADOW_ENGINE_STAMP},
+    {"outline", SHADOW_ENGINE_OUTLINE},
+    {"soft_outline", SHADOW_ENGINE_SOFT_OUTLINE}
+};
+
+ShadowEngine parse_shadow_engine(const char *name) {
+    for(const auto &i : shadow_engine_names)
+        if(std::strcmp(name, i.name) == 0)
+            return i.engine;
+    dmhm_assert(!"Unknown shadow engine");
+    return SHADOW_ENGINE_BOX;
+}
+
+bool is_valid_shadow_engine(const char *name) {
+    for(const auto &i : shadow_engine_names)
+        if(std::strcmp(name, i.name) == 0)
+            return true;
+    return false;
+}
+
+void compute_blur_boxes(double sigma, uint32_t boxes[blur_box_rounds], uint32_t rounds) {
+    const uint32_t n = rounds;
+
+    double wIdeal = std::sqrt(12*sigma*sigma/n+1);
+    uint32_t wl = std::floor(wIdeal);
+    if((wl & 1) == 0)
+        wl--;
+    uint32_t wu = wl+2;
+    double mIdeal = (12*sigma*sigma - n*wl*wl - 4*n*wl - 3*n)/(-4*wl - 4);
+    uint32_t m = uint32_t(mIdeal);
+
+    for(uint32_t i = 0; i < blur_box_rounds; i++)
+        boxes[i] = i>=n ? 1 : i<m ? wl : wu;
+}
+
+/* Thanks to http://blog.ivank.net/fastest-gaussian-blur.html
+   I rewrote the original algorithm in C++*/
+void gauss_blur_box(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, const uint32_t boxes[blur_box_rounds]) {
+    const uint32_t *bxs = boxes;
+    box_blur(scl, tcl, w, h, int32_t((bxs[0]-1)/2));
+    if(bxs[1] > 1)
+        box_blur(tcl, scl, w, h, int32_t((bxs[1]-1)/2));
+    else
+        std::copy(tcl, tcl+w*h, scl);
+    // box_blur(scl, tcl, w, h, int32_t((bxs[2]-1)/2)); // Two times are enough, the result is in scl instead
+}
+
+static void box_blur(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r) {
+    for(int32_t i = 0; i < w*h; i++)
+        tcl[i] = scl[i];
+    box_blur_H(tcl, scl, w, h, r);
+    box_blur_T(scl, tcl, w, h, r);
+}
+
+static void box_blur_H(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r) {
+    uint32_t iarr = r*2+1;
+    for(int32_t i = 0; i < h; i++) {
+        int32_t ti = i*w, li = ti, ri = ti+r;
+        uint32_t fv = scl[ti], lv = scl[ti+w-1], val = (r+1)*fv;
+        for(int32_t j = 0; j < r; j++)
+            val += scl[ti+j];
+        for(int32_t j = 0; j <= r; j++) {
+            val += scl[ri++] - fv;
+            tcl[ti++] = val/iarr;
+        }
+        for(int32_t j = r+1; j < w-r; j++) {
+            val += scl[ri++] - scl[li++];
+            tcl[ti++] = val/iarr;
+        }
+        for(int32_t j = w-r; j < w; j++) {
+            val += lv - scl[li++];
+            tcl[ti++] = val/iarr;
+        }
+    }
+}
+
+static void box_blur_T(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r) {
+    uint32_t iarr = r*2+1;
+    for(int32_t i = 0; i < w; i++) {
+        int32_t ti = i, li = ti, ri = ti+r*w;
+        uint32_t fv = scl[ti], lv = scl[ti+w*(h-1)], val = (r+1)*fv;
+        for(int32_t j = 0; j < r; j++)
+            val += scl[ti+j*w];
+        for(int32_t j = 0; j <= r; j++) {
+            val += scl[ri] - fv;
+            tcl[ti] = val/iarr;
+            ri += w; ti += w;
+        }
+        for(int32_t j = r+1; j < h-r; j++) {
+            val += scl[ri] - scl[li];
+            tcl[ti] = val/iarr;
+            li += w; ri += w; ti += w;
+        }
+        for(int32_t j = h-r; j < h; j++) {
+            val += lv - scl[li];
+            tcl[ti] = val/iarr;
+            li += w; ti += w;
+        }
+    }
+}
+
+
+/* About the visible spread of a Gaussian shadow of this sigma */
+uint32_t compute_outline_radius(double sigma) {
+    return std::max(uint32_t(std::lround(sigma)), uint32_t(1));
+}
+
+void outline_alpha(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, uint32_t radius, bool soft, std::vector<uint32_t> &workspace) {
+    int32_t r = int32_t(radius);
+    int32_t k = 2*r+1;
+    /* dilate_H needs a padded row and two blocks, dilate_T a zero row and two blocks of rows */
+    workspace.resize(std::max(size_t(w+2*r+2*k) + size_t(2*k), size_t(2*k+1)*w));
+    dilate_H(scl, tcl, w, h, r, workspace.data());
+    dilate_T(tcl, scl, w, h, r, workspace.data());
+    if(soft) {
+        smooth_3x3(scl, tcl, w, h, workspace.data());
+        std::copy(tcl, tcl+w*h, scl);
+    }
+}
+
+/* Mean of 3x3 with zeros outside, the column sums of each row vectorize */
+static void smooth_3x3(const uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, uint32_t *workspace) {
+    uint32_t *column_sum = workspace;
+    column_sum[0] = 0;
+    column_sum[w+1] = 0;
+    for(int32_t i = 0; i < h; i++) {
+        const uint32_t *above = scl + (i > 0 ? i-1 : i)*w;
+        const uint32_t *row = scl + i*w;
+        const uint32_t *below = scl + (i+1 < h ? i+1 : i)*w;
+        uint32_t above_weight = i > 0 ? 1 : 0, below_weight = i+1 < h ? 1 : 0;
+        for(int32_t j = 0; j < w; j++)
+            column_sum[j+1] = above[j]*above_weight + row[j] + below[j]*below_weight;
+        uint32_t *dst = tcl + i*w;
+        /* x*7282 >> 16 is x/9 for x up to 9*255 */
+        for(int32_t j = 0; j < w; j++)
+            dst[j] = ((column_sum[j] + column_sum[j+1] + column_sum[j+2])*7282) >> 16;
+    }
+}
+
+/* Max over a sliding window in three comparisons per pixel, after
+   M. van Herk, "A fast algorithm for local minimum and maximum filters on
+   rectangular and octagonal kernels", Pattern Recognition Letters 13 (1992)
+   and J. Gil, M. Werman, "Computing 2-D min, median, and max filters",
+   IEEE Trans. PAMI 15 (1993). The input is split into blocks of the window
+   size, any window is the suffix of one block and the prefix of the next.
+   Outside the plane counts as zero. */
+static void dilate_H(const uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r, uint32_t *workspace) {
+    int32_t k = 2*r+1;
+    int32_t padded_size = w+2*r+2*k;
+    uint32_t *padded = workspace;
+    uint32_t *suffix = padded + padded_size;
+    uint32_t *prefix = suffix + k;
+    std::fill(padded, padded + padded_size, 0);
+    for(int32_t i = 0; i < h; i++) {
+        std::copy(scl + i*w, scl + (i+1)*w, padded + r);
+        uint32_t *dst = tcl + i*w;
+        for(int32_t base = 0; base < w; base += k) {
+            suffix[k-1] = padded[base+k-1];
+            for(int32_t t = k-2; t >= 0; t--)
+                suffix[t] = std::max(padded[base+t], suffix[t+1]);
+            prefix[0] = padded[base+k];
+            for(int32_t t = 1; t < k; t++)
+                prefix[t] = std::max(padded[base+k+t], prefix[t-1]);
+            int32_t count = std::min(k, w-base);
+            dst[base] = suffix[0];
+            for(int32_t t = 1; t < count; t++)
+                dst[base+t] = std::max(suffix[t], prefix[t-1]);
+        }
+    }
+}
+
+/* The same on whole rows at a time, so the inner loops run along a row and vectorize */
+static void dilate_T(const uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r, uint32_t *workspace) {
+    int32_t k = 2*r+1;
+    uint32_t *zero_row = workspace;
+    uint32_t *suffix = zero_row + w;
+    uint32_t *prefix = suffix + size_t(k)*w;
+    std::fill(zero_row, zero_row + w, 0);
+    auto row = [&](int32_t padded_index) -> const uint32_t * {
+        int32_t i = padded_index-r;
+        return i >= 0 && i < h ? scl + size_t(i)*w : zero_row;
+    };
+    for(int32_t base = 0; base < h; base += k) {
+        std::copy(row(base+k-1), row(base+k-1) + w, suffix + size_t(k-1)*w);
+        for(int32_t t = k-2; t >= 0; t--) {
+            const uint32_t *src = row(base+t), *next = suffix + size_t(t+1)*w;
+            uint32_t *dst = suffix + size_t(t)*w;
+            for(int32_t j = 0; j < w; j++)
+                dst[j] = std::max(src[j], next[j]);
+        }
+        std::copy(row(base+k), row(base+k) + w, prefix);
+        for(int32_t t = 1; t < k; t++) {
+            const uint32_t *src = row(base+k+t), *last = prefix + size_t(t-1)*w;
+            uint32_t *dst = prefix + size_t(t)*w;
+            for(int32_t j = 0; j < w; j++)
+                dst[j] = std::max(src[j], last[j]);
+        }
+        int32_t count = std::min(k, h-base);
+        std::copy(suffix, suffix + w, tcl + size_t(base)*w);
+        for(int32_t t = 1; t < count; t++) {
+            const uint32_t *a = suffix + size_t(t)*w, *b = prefix + size_t(t-1)*w;
+            uint32_t *dst = tcl + size_t(base+t)*w;
+            for(int32_t j = 0; j < w; j++)
+                dst[j] = std::max(a[j], b[j]);
+        }
+    }
+}
+
+/* Initial history of the backward pass, with the input replicated beyond
+   the edge as in B. Triggs, M. Sdika, "Boundary conditions for Young-van
+   Vliet recursive filtering", IEEE Trans. Signal Processing 54 (2006).
+   The history is linear in the last three forward outputs minus the edge
+   input, the matrix is found by filtering each unit vector through a tail
+   long enough for the poles to decay. */
+static void iir_boundary_matrix(float b1, float b2, float b3, float B, double q, double M[9]) {
+    size_t tail_length = size_t(20*q) + 32;
+    std::vector<double> tail(tail_length);
+    for(int k = 0; k < 3; k++) {
+        double h[3] = {0, 0, 0};
+        h[k] = 1;
+        for(size_t n = 0; n < tail_length; n++) {
+            tail[n] = b1*h[0] + b2*h[1] + b3*h[2];
+            h[2] = h[1]; h[1] = h[0]; h[0] = tail[n];
+        }
+        h[0] = h[1] = h[2] = 0;
+        for(size_t n = tail_length; n-- > 0;) {
+            tail[n] = B*tail[n] + b1*h[0] + b2*h[1] + b3*h[2];
+            h[2] = h[1]; h[1] = h[0]; h[0] = tail[n];
+        }
+        for(int i = 0; i < 3; i++)
+            M[i*3 + k] = tail[i];
+    }
+}
+
+/* I. T. Young, L. J. van Vliet, "Recursive implementation of the Gaussian
+   filter", Signal Processing 44 (1995) 139-151.
+   Rows are filtered one by one, columns are filtered a whole row at a time
+   so the inner loops run over contiguous memory. */
+void gauss_blur_iir(uint32_t *scl, int32_t w, int32_t h, double sigma, std::vector<float> &workspace) {
+    if(sigma < 0.5 || w < 3 || h < 3)
+        return;
+    double q = sigma >= 2.5 ?
+        0.98711*sigma - 0.96330 :
+        3.97156 - 4.14554*std::sqrt(1 - 0.26891*sigma);
+    double b0 = 1.57825 + 2.44413*q + 1.4281*q*q + 0.422205*q*q*q;
+    const float b1 = float((2.44413*q + 2.85619*q*q + 1.26661*q*q*q)/b0);
+    const float b2 = float(-(1.4281*q*q + 1.26661*q*q*q)/b0);
+    const float b3 = float(0.422205*q*q*q/b0);
+    const float B = 1 - (b1+b2+b3);
+    double M[9];
+    iir_boundary_matrix(b1, b2, b3, B, q, M);
+
+    /* Plane, the last input row, and three history rows */
+    workspace.resize(size_t(w)*(h+4));
+    float *plane = workspace.data();
+    float *edge_row = plane + size_t(w)*h;
+    float *hist = edge_row + w;
+
+    /* Horizontal */
+    for(int32_t i = 0; i < h; i++) {
+        const uint32_t *src = scl + size_t(i)*w;
+        float *row = plane + size_t(i)*w;
+        /* A constant input stays constant, so replicating it is exact */
+        float w1 = float(src[0]), w2 = w1, w3 = w1;
+        for(int32_t j = 0; j < w; j++) {
+            float w0 = B*float(src[j]) + b1*w1 + b2*w2 + b3*w3;
+            row[j] = w0;
+            w3 = w2; w2 = w1; w1 = w0;
+        }
+        float u = float(src[w-1]);
+        float d0 = row[w-1]-u, d1 = row[w-2]-u, d2 = row[w-3]-u;
+        w1 = float(M[0]*d0 + M[1]*d1 + M[2]*d2) + u;
+        w2 = float(M[3]*d0 + M[4]*d1 + M[5]*d2) + u;
+        w3 = float(M[6]*d0 + M[7]*d1 + M[8]*d2) + u;
+        for(int32_t j = w-1; j >= 0; j--) {
+            float w0 = B*row[j] + b1*w1 + b2*w2 + b3*w3;
+            row[j] = w0;
+            w3 = w2; w2 = w1; w1 = w0;
+        }
+    }
+
+    /* Vertical, forward */
+    std::copy(plane + size_t(w)*(h-1), plane + size_t(w)*h, edge_row);
+    for(int32_t i = 1; i < h; i++) {
+        float *row = plane + size_t(i)*w;
+        const float *r1 = plane + size_t(i-1)*w;
+        const float *r2 = plane + size_t(std::max(i-2, 0))*w;
+        const float *r3 = plane + size_t(std::max(i-3, 0))*w;
+        for(int32_t j = 0; j < w; j++)
+            row[j] = B*row[j] + b1*r1[j] + b2*r2[j] + b3*r3[j];
+    }
+
+    /* Vertical, backward, then write back */
+    {
+        const float *u = edge_row;
+        const float *w0 = plane + size_t(h-1)*w;
+        const float *w1 = plane + size_t(h-2)*w;
+        const float *w2 = plane + size_t(h-3)*w;
+        for(int32_t k = 0; k < 3; k++)
+            for(int32_t j = 0; j < w; j++)
+                hist[size_t(k)*w + j] = float(M[k*3]*(w0[j]-u[j]) + M[k*3+1]*(w1[j]-u[j]) + M[k*3+2]*(w2[j]-u[j])) + u[j];
+    }
+    for(int32_t i = h-1; i >= 0; i--) {
+        float *row = plane + size_t(i)*w;
+        const float *r1 = i+1 < h ? plane + size_t(i+1)*w : hist;
+        const float *r2 = i+2 < h ? plane + size_t(i+2)*w : hist + size_t(i+2-h)*w;
+        const float *r3 = i+3 < h ? plane + size_t(i+3)*w : hist + size_t(i+3-h)*w;
+        uint32_t *dst = scl + size_t(i)*w;
+        for(int32_t j = 0; j < w; j++) {
+            row[j] = B*row[j] + b1*r1[j] + b2*r2[j] + b3*r3[j];
+            dst[j] = uint32_t(std::min(std::max(row[j], 0.0f), 255.0f) + 0.5f);
+        }
+    }
+}
+
+void downsample_alpha(const uint32_t *src, uint32_t src_stride, int32_t w, int32_t h, uint32_t *dst, uint32_t dst_stride, uint32_t factor) {
+    int32_t f = int32_t(factor);
+    for(int32_t i = 0; i < h; i += f) {
+        int32_t rows = std::min(f, h-i);
+        uint32_t *dst_row = dst + (i/f)*dst_stride;
+        for(int32_t j = 0; j < w; j += f) {
+            int32_t cols = std::min(f, w-j);
+            uint32_t sum = 0;
+            for(int32_t k = 0; k < rows; k++)
+                for(int32_t l = 0; l < cols; l++)
+                    sum += src[(i+k)*src_stride + j+l] >> 24;
+            uint32_t count = uint32_t(rows*cols);
+            dst_row[j/f] = (sum + count/2) / count;
+        }
+    }
+}
+
+/* Source position of each output pixel, 8-bit fractional weight toward the next sample */
+static void upsample_taps(int32_t src_len, int32_t len, int32_t f, std::vector<int32_t> &index, std::vector<uint32_t> &weight) {
+    index.resize(len);
+    weight.resize(len);
+    for(int32_t i = 0; i < len; i++) {
+        /* Center of output pixel i is at (2i+1)/2f in source pixels, minus 1/2 for the sample center */
+        int32_t pos = ((2*i+1-f)*256)/(2*f);
+        if(2*i+1 < f)
+            pos = 0;
+        int32_t idx = pos >> 8;
+        uint32_t frac = uint32_t(pos & 0xff);
+        if(idx >= src_len-1) {
+            idx = src_len-1;
+            frac = 0;
+        }
+        index[i] = idx;
+        weight[i] = frac;
+    }
+}
+
+void upsample_bilinear(const uint32_t *src, uint32_t src_stride, int32_t src_w, int32_t src_h, uint32_t *dst, uint32_t dst_stride, int32_t w, int32_t h, uint32_t factor) {
+    std::vector<int32_t> x_index, y_index;
+    std::vector<uint32_t> x_weight, y_weight;
+    upsample_taps(src_w, w, int32_t(factor), x_index, x_weight);
+    upsample_taps(src_h, h, int32_t(factor), y_index, y_weight);
+    for(int32_t i = 0; i < h; i++) {
+        const uint32_t *row0 = src + y_index[i]*src_stride;
+        const uint32_t *row1 = y_index[i]+1 < src_h ? row0 + src_stride : row0;
+        uint32_t wy = y_weight[i];
+        uint32_t *dst_row = dst + i*dst_stride;
+        for(int32_t j = 0; j < w; j++) {
+            int32_t x0 = x_index[j];
+            int32_t x1 = x0+1 < src_w ? x0+1 : x0;
+            uint32_t wx = x_weight[j];
+            uint32_t top = row0[x0]*(256-wx) + row0[x1]*wx;
+            uint32_t bottom = row1[x0]*(256-wx) + row1[x1]*wx;
+            dst_row[j] = (top*(256-wy) + bottom*wy + 32768) >> 16;
+        }
+    }
+}
+
+}
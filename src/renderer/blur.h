@@ -0,0 +1,63 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace dmhm {
+
+/* Gaussian blur kernels over 8-bit values stored one per uint32_t,
+   the result is written back to scl */
+
+static const uint32_t blur_box_rounds = 2;
+
+enum ShadowEngine {
+    SHADOW_ENGINE_BOX,
+    SHADOW_ENGINE_IIR,
+    SHADOW_ENGINE_STAMP,
+    SHADOW_ENGINE_OUTLINE,
+    SHADOW_ENGINE_SOFT_OUTLINE
+};
+
+ShadowEngine parse_shadow_engine(const char *name);
+bool is_valid_shadow_engine(const char *name);
+
+/* Successive box blurs from running sums, constant cost per pixel for any sigma, about the
+   same as the recursive filter but a rougher Gaussian.
+   With fewer rounds the remaining boxes are 1 wide and skipped, cheaper but less round */
+void compute_blur_boxes(double sigma, uint32_t boxes[blur_box_rounds], uint32_t rounds = blur_box_rounds);
+void gauss_blur_box(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, const uint32_t boxes[blur_box_rounds]);
+
+/* Young-van Vliet recursive filter, constant cost per pixel for any sigma, the more accurate Gaussian */
+void gauss_blur_iir(uint32_t *scl, int32_t w, int32_t h, double sigma, std::vector<float> &workspace);
+
+/* Outline instead of a shadow, the text alpha dilated by a square of 2*radius+1,
+   with soft the edge is smoothed by a 3x3 mean. Constant cost per pixel for any radius */
+uint32_t compute_outline_radius(double sigma);
+void outline_alpha(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, uint32_t radius, bool soft, std::vector<uint32_t> &workspace);
+
+/* Reduced resolution shadows, blur at sigma/factor in between.
+   downsample_alpha averages factor x factor blocks of the alpha channel of ARGB32 pixels,
+   upsample_bilinear stretches the result back with sample centers aligned to those blocks */
+void downsample_alpha(const uint32_t *src, uint32_t src_stride, int32_t w, int32_t h, uint32_t *dst, uint32_t dst_stride, uint32_t factor);
+void upsample_bilinear(const uint32_t *src, uint32_t src_stride, int32_t src_w, int32_t src_h, uint32_t *dst, uint32_t dst_stride, int32_t w, int32_t h, uint32_t factor);
+
+}
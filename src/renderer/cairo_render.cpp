@@ -20,42 +20,63 @@
 #include "cairo_render.h"
 #include "../utils.h"
 #include "../app.h"
+#include "../clock.h"
 #include "../config.h"
-#include "../fetcher/fetcher.h"
 #include "../presenter/presenter.h"
+#include "blur.h"
+#include "density_governor.h"
+#include "font_chain.h"
+#include "frame_ring.h"
+#include "glyph_cache.h"
+#include "prerasterizer.h"
+#include "quality_governor.h"
+#include "shadow_stamp.h"
+#include "thread_pool.h"
+#include "video_sink.h"
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <chrono>
 #include <functional>
 #include <iostream>
 #include <list>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <cairo/cairo.h>
-#include <cairo/cairo-ft.h>
 #include "freetype_includer.h"
 
-#ifdef CAIRO_STATIC_WORKAROUND
-extern "C" void _cairo_mutex_initialize();
-#endif
-
 namespace dmhm {
 
 struct DanmakuAnimator;
 
 struct CairoRendererPrivate {
     Application *app = nullptr;
+    /* A virtual clock moves on by clock_step after each frame */
+    Clock *clock = nullptr;
+    void step_clock();
 
     /* Stage size */
     uint32_t width = 0;
     uint32_t height = 0;
 
-    FT_Library freetype = nullptr;
-    FT_Face ft_font_face = nullptr;
-    cairo_font_face_t *cairo_font_face = nullptr;
+    std::thread init_thread;
+    FT_Error ft_error = 0;
+    std::unique_ptr<FontChain> font_chain;
+    void init_fonts();
+    /* Lays out new messages in the background once fonts are loaded */
+    std::unique_ptr<Prerasterizer> prerasterizer;
+    /* Or lines come from a recorded timeline, up to timeline_cursor so far */
+    const std::vector<PreparedDanmaku> *timeline = nullptr;
+    size_t timeline_cursor = 0;
 
     cairo_surface_t *cairo_blend_surface = nullptr;
     cairo_t *cairo_blend_layer = nullptr;
+    uint32_t *frame_buffer = nullptr; // Backs the blend layer when the presenter provides it
+    uint32_t frame_buffer_stride = 0;
     cairo_surface_t *cairo_blur_surface = nullptr;
     cairo_t *cairo_blur_layer = nullptr;
     cairo_surface_t *cairo_text_surface = nullptr;
@@ -63,145 +84,327 @@ struct CairoRendererPrivate {
 
     bool is_eof = false;
     std::list<DanmakuAnimator> danmaku_list;
+    DensityGovernor density_governor;
+
+    /* Phase changes are kept in a heap by time, so each frame only touches lines
+       whose phase changes, lines flying in or fading out, and all lines while they scroll */
+    enum LifecycleStage {
+        LIFECYCLE_ATTACK_END,
+        LIFECYCLE_DECAY_START,
+        LIFECYCLE_EXPIRE
+    };
+    struct LifecycleEvent {
+        std::chrono::steady_clock::time_point time;
+        uint64_t serial;
+        LifecycleStage stage;
+        bool operator>(const LifecycleEvent &other) const { return time > other.time; }
+    };
+    std::priority_queue<LifecycleEvent, std::vector<LifecycleEvent>, std::greater<LifecycleEvent>> lifecycle_events;
+    std::unordered_map<uint64_t, std::list<DanmakuAnimator>::iterator> animator_index; // By serial
+    std::vector<uint64_t> fading_serials; // In attack or decay, may hold lines already removed
+    bool scrolling = false;
+    void schedule_lifecycle(const DanmakuAnimator &animator, LifecycleStage stage, double seconds);
+    void remove_animator(std::list<DanmakuAnimator>::iterator it);
 
     void create_cairo(cairo_surface_t *&cairo_surface, cairo_t *&cairo);
     static void release_cairo(cairo_surface_t *&cairo_surface, cairo_t *&cairo);
+
+    /* Only rows from band_top to the bottom of the stage hold text or shadow,
+       it moves in steps of band_quantum so that presenters seldom resize */
+    static const uint32_t band_quantum = 64;
+    uint32_t band_top = 0;
+    void update_band();
+    void clear_rows(cairo_t *cairo, uint32_t top, uint32_t bottom);
+
+    /* Where each line was painted in the last frame, newest first */
+    struct FrameLine {
+        uint64_t serial;
+        double x;
+        int32_t baseline;
+        uint32_t alpha_fixed;
+        int32_t top;
+        int32_t bottom;
+    };
+    uint64_t next_serial = 0;
+    std::vector<FrameLine> frame_lines;
+    bool frame_reusable = false;
+    uint32_t frame_band_top = 0;
+    void get_frame_lines(std::vector<FrameLine> &lines);
+    void save_frame_lines();
+    bool scroll_frame();
+    void shift_rows(cairo_surface_t *cairo_surface, int32_t shift);
+    bool prepare_layers(uint32_t width, uint32_t height);
+    void draw_stage();
     void fetch_danmaku(std::chrono::steady_clock::time_point now);
+    void fetch_timeline(std::chrono::steady_clock::time_point now);
+    void admit_danmaku(const DanmakuEntry &entry, GlyphRun &&glyph_run, std::vector<DanmakuAnimator> &arrivals, double &rise);
+    void stack_arrivals(std::chrono::steady_clock::time_point now, std::vector<DanmakuAnimator> &arrivals, double rise);
     void animate_text(std::chrono::steady_clock::time_point now);
-    void paint_text();
-    void blend_layers();
 
-    static const uint32_t blur_rounds = 2;
+    /* Rows of the stage are rendered in pieces, in parallel when there are threads,
+       every pass gives the same pixels however the rows are split */
+    struct LayerBitmaps {
+        uint32_t *text; uint32_t text_stride;
+        uint32_t *blur; uint32_t blur_stride;
+        uint32_t *blend; uint32_t blend_stride;
+    };
+    typedef std::vector<std::pair<uint32_t, uint32_t>> RowPieces;
+    struct PieceWorkspace {
+        std::vector<uint32_t> planes;
+        std::vector<uint32_t> filter;
+    };
+    std::unique_ptr<ThreadPool> thread_pool;
+    std::vector<PieceWorkspace> piece_workspace;
+    LayerBitmaps begin_layers();
+    void end_layers();
+    void render_band();
+    static void split_rows(uint32_t top, uint32_t bottom, uint32_t piece_rows, RowPieces &pieces);
+    void render_pieces(const RowPieces &pieces);
+    /* In tiles, each piece goes through all passes in buffers of its own that stay in cache,
+       there are no text and blur layers then */
+    bool tiled = false;
+    uint32_t get_tile_rows() const;
+    void render_tile(const LayerBitmaps &layers, uint32_t top, uint32_t bottom, PieceWorkspace &workspace);
+    void paint_text(const LayerBitmaps &layers, uint32_t top, uint32_t bottom);
+    static void paint_glyph_run(uint32_t *bitmap, uint32_t stride, int32_t width, int32_t clip_top, int32_t clip_bottom, const GlyphRun &run, double x, double y, double alpha);
+    void paint_shadow_stamps(uint32_t *bitmap, uint32_t stride, uint32_t top, uint32_t bottom);
+    void blur_rows(const LayerBitmaps &layers, uint32_t top, uint32_t bottom, PieceWorkspace &workspace);
+    void blur_band(const LayerBitmaps &layers);
+    void blend_rows(const LayerBitmaps &layers, uint32_t top, uint32_t bottom);
+    void blend_row(const uint32_t *text, const uint32_t *blur, uint32_t *blend);
+    static uint32_t composite_over(uint32_t src, uint32_t dst);
+
+    ShadowEngine shadow_engine = SHADOW_ENGINE_BOX;
     uint32_t gamma_table[256];
-    uint32_t blur_boxes[blur_rounds];
+    uint32_t shadow_downsample = 1;
+    double blur_sigma = 0; // At the reduced resolution when shadow_downsample > 1
+    uint32_t blur_boxes[blur_box_rounds];
+    uint32_t outline_radius = 1;
+    std::vector<float> blur_workspace;
+    std::vector<uint32_t> small_blur_bitmap;
+    std::vector<uint32_t> small_blur_temp;
+    std::vector<uint32_t> small_filter_workspace;
+    /* The box blur or the outline, in place on 8-bit values */
+    void filter_shadow(uint32_t *plane, uint32_t *temp, int32_t w, int32_t h, std::vector<uint32_t> &workspace);
+    void blur_downsampled(const uint32_t *text_bitmap, uint32_t text_stride, uint32_t *blur_bitmap, uint32_t blur_stride, uint32_t rows);
+    std::unique_ptr<ShadowStampCache> shadow_stamps;
     void generate_blur_boxes();
-    void gauss_blur(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h);
-    static void box_blur(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r);
-    static void box_blur_H(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r);
-    static void box_blur_T(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r);
+    uint32_t blur_reach() const;
+
+    /* Quality is lowered in tiers when frames cannot keep up with max_fps */
+    std::unique_ptr<QualityGovernor> governor;
+    /* Every frame is also published here when frame_ring is set */
+    std::unique_ptr<FrameRing> frame_ring;
+    /* And recorded here when video_output is set */
+    std::unique_ptr<VideoSink> video_sink;
+    uint32_t blur_rounds = blur_box_rounds;
+    double radius_scale = 1;
+    uint32_t frame_interval = 1;
+    uint32_t frame_phase = 0;
+    std::vector<QualityTier> get_quality_tiers() const;
+    void apply_quality(const QualityTier &tier);
 
     std::chrono::steady_clock::time_point fps_checkpoint;
     uint32_t fps_count;
     void print_fps(std::chrono::steady_clock::time_point now);
+
+    std::chrono::steady_clock::duration font_load_time = std::chrono::steady_clock::duration::zero();
+    bool first_frame_shown = false;
+    void print_startup_time();
 };
 
 CairoRenderer::CairoRenderer(Application *app) {
     p->app = app;
+    p->clock = app->get_clock();
+
+    /* Fonts are loaded while the presenter creates its window,
+       the presenter is not usable yet, so errors are reported in wait_ready */
+    p->init_thread = std::thread([&]() {
+        p->init_fonts();
+    });
+
+    p->shadow_engine = parse_shadow_engine(config::shadow_engine);
+    std::vector<QualityTier> tiers = p->get_quality_tiers();
+    p->apply_quality(tiers[0]);
+    /* Frames that cost a different time must not look different under a virtual clock */
+    if(config::adaptive_quality && !p->clock->is_virtual())
+        p->governor.reset(new QualityGovernor(tiers, config::max_fps));
+    if(*config::frame_ring != '\0')
+        p->frame_ring.reset(new FrameRing(config::frame_ring, config::frame_ring_slots));
+    if(*config::video_output != '\0')
+        p->video_sink.reset(new VideoSink(config::video_output, config::video_format, config::video_fps != 0 ? config::video_fps : config::max_fps, config::video_queue_frames));
+
+    uint32_t render_threads = config::render_threads;
+    if(render_threads == 0)
+        render_threads = std::max(std::min(std::thread::hardware_concurrency()/2, 4u), 1u);
+    p->thread_pool.reset(new ThreadPool(render_threads));
 
-    /* Initialize fonts */
-    FT_Error ft_error;
-    ft_error = FT_Init_FreeType(&p->freetype);
-    dmhm_assert(ft_error == 0);
-    ft_error = FT_New_Face(p->freetype, config::font_file, config::font_file_index, &p->ft_font_face);
-    if(ft_error == FT_Err_Cannot_Open_Resource) {
-        Presenter *presenter = reinterpret_cast<Presenter *>(app->get_presenter());
+    p->fps_checkpoint = std::chrono::steady_clock::now();
+    p->fps_count = 0;
+}
+
+/* Frames of a timeline are painted in parallel by several renderers, each on one thread
+   unless told otherwise, at full quality however long they take */
+CairoRenderer::CairoRenderer(const std::vector<PreparedDanmaku> &timeline, uint32_t render_threads) {
+    p->timeline = &timeline;
+    p->shadow_engine = parse_shadow_engine(config::shadow_engine);
+    p->apply_quality(p->get_quality_tiers()[0]);
+    p->thread_pool.reset(new ThreadPool(render_threads));
+}
+
+void CairoRenderer::wait_ready() {
+    if(!p->init_thread.joinable())
+        return;
+    p->init_thread.join();
+    if(p->ft_error == FT_Err_Cannot_Open_Resource) {
+        Presenter *presenter = reinterpret_cast<Presenter *>(p->app->get_presenter());
         dmhm_assert(presenter);
         // Failed to open font file
         presenter->report_error(std::string("\xe6\x89\x93\xe5\xbc\x80\xe5\xad\x97\xe4\xbd\x93\xe6\x96\x87\xe4\xbb\xb6\x20")+config::font_file+std::string("\x20\xe5\xa4\xb1\xe8\xb4\xa5"));
         abort();
     }
-    if(ft_error == FT_Err_Unknown_File_Format) {
-        Presenter *presenter = reinterpret_cast<Presenter *>(app->get_presenter());
+    if(p->ft_error == FT_Err_Unknown_File_Format) {
+        Presenter *presenter = reinterpret_cast<Presenter *>(p->app->get_presenter());
         dmhm_assert(presenter);
         // Unsupported font format
         presenter->report_error(std::string("\xe6\x97\xa0\xe6\xb3\x95\xe8\xaf\x86\xe5\x88\xab\xe7\x9a\x84\xe5\xad\x97\xe4\xbd\x93\xe6\x96\x87\xe4\xbb\xb6\x20")+config::font_file);
         abort();
     }
-    dmhm_assert(ft_error == 0);
-    ft_error = FT_Set_Char_Size(p->ft_font_face, 0, FT_F26Dot6(config::font_size*64), 72, 72);
-    dmhm_assert(ft_error == 0);
-
-#ifdef CAIRO_STATIC_WORKAROUND
-    /* There is a bug in _cairo_ft_unscaled_font_map_lock,
-       causing mutex not being initialized correctly.
-       I will hack it dirtly by calling a private API.
-       This problem only occurs on static linking. */
-    _cairo_mutex_initialize();
-#endif
-
-    p->cairo_font_face = cairo_ft_font_face_create_for_ft_face(p->ft_font_face, 0);
-
-    p->generate_blur_boxes();
-
-    p->fps_checkpoint = std::chrono::steady_clock::now();
-    p->fps_count = 0;
+    dmhm_assert(p->ft_error == 0);
+    p->prerasterizer.reset(new Prerasterizer(p->app, p->font_chain.get()));
 }
 
 CairoRenderer::~CairoRenderer() {
+    if(p->init_thread.joinable())
+        p->init_thread.join();
+
     p->release_cairo(p->cairo_text_surface, p->cairo_text_layer);
+    p->release_cairo(p->cairo_blur_surface, p->cairo_blur_layer);
     p->release_cairo(p->cairo_blend_surface, p->cairo_blend_layer);
 
-    FT_Error ft_error;
-    if(p->cairo_font_face) {
-        cairo_font_face_destroy(p->cairo_font_face);
-        p->cairo_font_face = nullptr;
-    }
-    if(p->ft_font_face) {
-        ft_error = FT_Done_Face(p->ft_font_face);
-        dmhm_assert(ft_error == 0);
-        p->ft_font_face = nullptr;
-    }
-    if(p->freetype) {
-        ft_error = FT_Done_FreeType(p->freetype);
-        dmhm_assert(ft_error == 0);
-        p->freetype = nullptr;
-    }
-}
-
-bool CairoRenderer::paint_frame(uint32_t width, uint32_t height, std::function<void (const uint32_t *bitmap, uint32_t stride)> callback) {
-    if(width != p->width || height != p->height) {
-        p->width = width;
-        p->height = height;
-        p->release_cairo(p->cairo_text_surface, p->cairo_text_layer);
-        p->release_cairo(p->cairo_blur_surface, p->cairo_blur_layer);
-        p->release_cairo(p->cairo_blend_surface, p->cairo_blend_layer);
-    }
-    if(!p->cairo_blend_layer)
-        p->create_cairo(p->cairo_blend_surface, p->cairo_blend_layer);
-    if(!p->cairo_blur_layer)
-        p->create_cairo(p->cairo_blur_surface, p->cairo_blur_layer);
-    if(!p->cairo_text_layer) {
-        p->create_cairo(p->cairo_text_surface, p->cairo_text_layer);
-        cairo_set_font_face(p->cairo_text_layer, p->cairo_font_face);
-        cairo_set_font_size(p->cairo_text_layer, config::font_size);
-        cairo_font_options_t *font_options = cairo_font_options_create();
-        cairo_get_font_options(p->cairo_text_layer, font_options);
-        cairo_font_options_set_antialias(font_options, CAIRO_ANTIALIAS_GRAY);
-        cairo_font_options_set_hint_style(font_options, CAIRO_HINT_STYLE_NONE);
-        cairo_font_options_set_hint_metrics(font_options, CAIRO_HINT_METRICS_OFF);
-        cairo_set_font_options(p->cairo_text_layer, font_options);
-        cairo_font_options_destroy(font_options);
-    }
-
-    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
-    p->print_fps(now);
+    p->prerasterizer.reset();
+    p->font_chain.reset();
+}
+
+bool CairoRenderer::paint_frame(uint32_t width, uint32_t height, std::function<void (const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height)> callback) {
+    wait_ready();
+    bool last_frame_kept = p->prepare_layers(width, height);
+
+    /* Animations follow the clock, while costs and rates are of real time */
+    std::chrono::steady_clock::time_point now = p->clock->now();
+    std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
+    /* At a lower frame rate, frames in between show the last one again */
+    if(p->frame_interval > 1 && last_frame_kept && ++p->frame_phase % p->frame_interval != 0) {
+        cairo_surface_flush(p->cairo_blend_surface);
+        const uint32_t *bitmap = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(p->cairo_blend_surface));
+        uint32_t stride = uint32_t(cairo_image_surface_get_stride(p->cairo_blend_surface)/sizeof (uint32_t));
+        if(p->frame_ring)
+            p->frame_ring->publish(bitmap, stride, width, height, p->band_top, true, frame_start);
+        if(p->video_sink)
+            p->video_sink->push_frame(bitmap, stride, width, height, p->band_top, now);
+        callback(bitmap, stride, p->band_top, height-p->band_top);
+        if(p->governor && p->governor->add_frame(std::chrono::steady_clock::now()-frame_start))
+            p->apply_quality(p->governor->get_tier());
+        p->step_clock();
+        return !p->is_eof || !p->danmaku_list.empty();
+    }
+    p->print_fps(frame_start);
+    p->density_governor.print_stats(now, p->danmaku_list.size());
+    if(p->video_sink)
+        p->video_sink->print_stats(frame_start);
     p->fetch_danmaku(now);
     p->animate_text(now);
+    p->draw_stage();
+
+    cairo_surface_flush(p->cairo_blend_surface);
+    const uint32_t *bitmap = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(p->cairo_blend_surface));
+    uint32_t stride = uint32_t(cairo_image_surface_get_stride(p->cairo_blend_surface)/sizeof (uint32_t));
+    if(p->frame_ring)
+        p->frame_ring->publish(bitmap, stride, width, height, p->band_top, false, frame_start);
+    if(p->video_sink)
+        p->video_sink->push_frame(bitmap, stride, width, height, p->band_top, now);
+    callback(bitmap, stride, p->band_top, height-p->band_top);
+    if(!p->first_frame_shown) {
+        p->first_frame_shown = true;
+        p->print_startup_time();
+    } else if(p->governor && p->governor->add_frame(std::chrono::steady_clock::now()-frame_start))
+        p->apply_quality(p->governor->get_tier());
+    p->step_clock();
+
+    return !p->is_eof || !p->danmaku_list.empty();
+}
 
-    if(!p->danmaku_list.empty()) {
-        cairo_set_operator(p->cairo_text_layer, CAIRO_OPERATOR_CLEAR);
-        cairo_paint(p->cairo_text_layer);
-        cairo_set_operator(p->cairo_text_layer, CAIRO_OPERATOR_OVER);
-        p->paint_text();
+void CairoRenderer::set_frame_buffer(uint32_t *bitmap, uint32_t stride) {
+    p->frame_buffer = bitmap;
+    p->frame_buffer_stride = stride;
+    p->frame_reusable = false;
+    p->release_cairo(p->cairo_blend_surface, p->cairo_blend_layer);
+}
+
+bool CairoRenderer::paint_frame_at(uint32_t width, uint32_t height, std::chrono::steady_clock::time_point time, std::function<void (const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height)> callback) {
+    dmhm_assert(p->timeline);
+    p->prepare_layers(width, height);
+    p->fetch_timeline(time);
+    p->animate_text(time);
+    p->draw_stage();
+
+    cairo_surface_flush(p->cairo_blend_surface);
+    callback(reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(p->cairo_blend_surface)), uint32_t(cairo_image_surface_get_stride(p->cairo_blend_surface)/sizeof (uint32_t)), p->band_top, height-p->band_top);
+    return !p->is_eof || !p->danmaku_list.empty();
+}
+
+/* Returns whether the blend layer still holds the last frame */
+bool CairoRendererPrivate::prepare_layers(uint32_t width, uint32_t height) {
+    if(width != this->width || height != this->height) {
+        this->width = width;
+        this->height = height;
+        band_top = 0;
+        frame_reusable = false;
+        release_cairo(cairo_text_surface, cairo_text_layer);
+        release_cairo(cairo_blur_surface, cairo_blur_layer);
+        release_cairo(cairo_blend_surface, cairo_blend_layer);
+    }
+    bool last_frame_kept = cairo_blend_layer != nullptr;
+    if(!cairo_blend_layer && frame_buffer) {
+        std::fill(frame_buffer, frame_buffer + size_t(frame_buffer_stride)*height, 0);
+        cairo_blend_surface = cairo_image_surface_create_for_data(reinterpret_cast<unsigned char *>(frame_buffer), CAIRO_FORMAT_ARGB32, width, height, frame_buffer_stride*sizeof (uint32_t));
+        cairo_blend_layer = cairo_create(cairo_blend_surface);
+    } else if(!cairo_blend_layer)
+        create_cairo(cairo_blend_surface, cairo_blend_layer);
+    if(!tiled && !cairo_blur_layer)
+        create_cairo(cairo_blur_surface, cairo_blur_layer);
+    if(!tiled && !cairo_text_layer)
+        create_cairo(cairo_text_surface, cairo_text_layer);
+    return last_frame_kept;
+}
 
-        cairo_set_operator(p->cairo_blend_layer, CAIRO_OPERATOR_CLEAR);
-        cairo_paint(p->cairo_blend_layer);
-        cairo_set_operator(p->cairo_blend_layer, CAIRO_OPERATOR_OVER);
-        p->blend_layers();
+void CairoRendererPrivate::draw_stage() {
+    update_band();
+    if(!danmaku_list.empty()) {
+        if(!scroll_frame())
+            render_band();
+        save_frame_lines();
     } else {
-        cairo_set_operator(p->cairo_blend_layer, CAIRO_OPERATOR_CLEAR);
-        cairo_paint(p->cairo_blend_layer);
-        cairo_set_operator(p->cairo_blend_layer, CAIRO_OPERATOR_OVER);
+        frame_reusable = false;
+        clear_rows(cairo_blend_layer, band_top, height);
         /* Workaround a wine bug by lighting up a few pixels */
-        cairo_set_source_rgba(p->cairo_blend_layer, 0.5, 0.5, 0.5, 0.004);
-        cairo_rectangle(p->cairo_blend_layer, 0.5, 0.5, 2, 2);
-        cairo_fill(p->cairo_blend_layer);
+        cairo_set_source_rgba(cairo_blend_layer, 0.5, 0.5, 0.5, 0.004);
+        cairo_rectangle(cairo_blend_layer, 0.5, band_top+0.5, 2, 2);
+        cairo_fill(cairo_blend_layer);
     }
+}
 
-    cairo_surface_flush(p->cairo_blend_surface);
-    callback(reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(p->cairo_blend_surface)), uint32_t(cairo_image_surface_get_stride(p->cairo_blend_surface)/sizeof (uint32_t)));
-
-    return !p->is_eof || !p->danmaku_list.empty();
+void CairoRendererPrivate::init_fonts() {
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    /* Fonts are mapped instead of read by FreeType,
+       so a 20 MB TTC is paged in only where glyphs are actually used */
+    font_chain.reset(new FontChain);
+    ft_error = font_chain->open_primary(config::font_file, config::font_file_index);
+    if(ft_error != 0)
+        return;
+    for(const std::string &i : config::fallback_font_files)
+        font_chain->add_fallback(i);
+    font_load_time = std::chrono::steady_clock::now()-start_time;
 }
 
 void CairoRendererPrivate::create_cairo(cairo_surface_t *&cairo_surface, cairo_t *&cairo) {
@@ -225,6 +428,9 @@ struct DanmakuAnimator {
         entry(entry) {
     }
     DanmakuEntry entry;
+    GlyphRun glyph_run;
+    uint64_t serial = 0;
+    double lifetime; // Seconds, may be shorter than danmaku_lifetime under load
     double x;
     double y;
     double height;
@@ -236,6 +442,172 @@ struct DanmakuAnimator {
     double endy;
 };
 
+void CairoRendererPrivate::update_band() {
+    /* The shadow spreads about shadow_radius around the ink */
+    double top = height;
+    for(const DanmakuAnimator &i : danmaku_list)
+        top = std::min(top, i.y-i.glyph_run.ink_top);
+    top -= std::ceil(config::shadow_radius)+1;
+    uint32_t new_top = top <= 0 ? 0 : uint32_t(top) / band_quantum * band_quantum;
+    new_top = std::min(new_top, height > band_quantum ? height-band_quantum : 0);
+    /* Rows leaving the band are cleared once, so the whole stage stays valid */
+    if(new_top > band_top) {
+        if(cairo_text_layer)
+            clear_rows(cairo_text_layer, band_top, new_top);
+        clear_rows(cairo_blend_layer, band_top, new_top);
+    }
+    band_top = new_top;
+}
+
+void CairoRendererPrivate::clear_rows(cairo_t *cairo, uint32_t top, uint32_t bottom) {
+    cairo_set_operator(cairo, CAIRO_OPERATOR_CLEAR);
+    cairo_rectangle(cairo, 0, top, width, bottom-top);
+    cairo_fill(cairo);
+    cairo_set_operator(cairo, CAIRO_OPERATOR_OVER);
+}
+
+void CairoRendererPrivate::get_frame_lines(std::vector<FrameLine> &lines) {
+    lines.clear();
+    for(const DanmakuAnimator &i : danmaku_list) {
+        FrameLine line;
+        line.serial = i.serial;
+        line.x = i.x;
+        line.baseline = int32_t(std::lround(i.y));
+        line.alpha_fixed = uint32_t(std::min(std::max(i.alpha, 0.0), 1.0)*256);
+        line.top = line.baseline-i.glyph_run.ink_top;
+        line.bottom = line.baseline+i.glyph_run.ink_bottom;
+        lines.push_back(line);
+    }
+}
+
+void CairoRendererPrivate::save_frame_lines() {
+    get_frame_lines(frame_lines);
+    frame_reusable = shadow_downsample == 1 && shadow_engine != SHADOW_ENGINE_IIR;
+    frame_band_top = band_top;
+}
+
+/* When the stack only scrolls, the last frame is shifted by whole rows and only rows
+   near lines that appeared, vanished or changed are painted again. Glyphs are snapped
+   to whole pixels and the box blur reaches a fixed distance, so the result is identical
+   to painting the whole band. Lines that scroll by a different number of rows, such as
+   at a different sub-pixel phase, are simply painted again */
+bool CairoRendererPrivate::scroll_frame() {
+    if(!frame_reusable || band_top != frame_band_top)
+        return false;
+    std::vector<FrameLine> lines;
+    get_frame_lines(lines);
+
+    /* Both lists are ordered by serial, newest first */
+    auto for_each_pair = [&](std::function<void (const FrameLine *now, const FrameLine *last)> callback) {
+        size_t i = 0, j = 0;
+        while(i < lines.size() || j < frame_lines.size())
+            if(j == frame_lines.size() || (i < lines.size() && lines[i].serial > frame_lines[j].serial))
+                callback(&lines[i++], nullptr);
+            else if(i == lines.size() || lines[i].serial < frame_lines[j].serial)
+                callback(nullptr, &frame_lines[j++]);
+            else {
+                callback(&lines[i], &frame_lines[j]);
+                i++; j++;
+            }
+    };
+
+    /* The scroll distance most unchanged lines agree on */
+    std::vector<std::pair<int32_t, uint32_t>> votes;
+    for_each_pair([&](const FrameLine *now, const FrameLine *last) {
+        if(!now || !last || now->x != last->x || now->alpha_fixed != last->alpha_fixed)
+            return;
+        int32_t shift = now->baseline-last->baseline;
+        auto it = std::find_if(votes.begin(), votes.end(), [&](const std::pair<int32_t, uint32_t> &x) { return x.first == shift; });
+        if(it == votes.end())
+            votes.push_back(std::make_pair(shift, 1));
+        else
+            it->second++;
+    });
+    if(votes.empty())
+        return false;
+    int32_t shift = std::max_element(votes.begin(), votes.end(), [](const std::pair<int32_t, uint32_t> &a, const std::pair<int32_t, uint32_t> &b) { return a.second < b.second; })->first;
+    int32_t band_rows = int32_t(height-band_top);
+    if(std::abs(shift) >= band_rows)
+        return false;
+
+    std::vector<std::pair<int32_t, int32_t>> dirty;
+    for_each_pair([&](const FrameLine *now, const FrameLine *last) {
+        if(now && last && now->x == last->x && now->alpha_fixed == last->alpha_fixed && now->baseline-last->baseline == shift)
+            return;
+        if(now)
+            dirty.push_back(std::make_pair(now->top, now->bottom));
+        if(last)
+            dirty.push_back(std::make_pair(last->top+shift, last->bottom+shift));
+    });
+    /* Rows shifted in from outside the band */
+    if(shift < 0)
+        dirty.push_back(std::make_pair(int32_t(height)+shift, int32_t(height)));
+    else if(shift > 0)
+        dirty.push_back(std::make_pair(int32_t(band_top), int32_t(band_top)+shift));
+
+    /* Shadows spread as far as the blur reaches, stamps are padded by the same */
+    int32_t reach = int32_t(blur_reach());
+    for(auto &i : dirty) {
+        i.first = std::max(i.first-reach, int32_t(band_top));
+        i.second = std::min(i.second+reach, int32_t(height));
+    }
+    /* The blur repeats the edge row beyond the band, near the edge it changes with the shift
+       when text is cut there, for example a line scrolling out of the top of the stage */
+    if(shift != 0) {
+        dirty.push_back(std::make_pair(int32_t(band_top), std::min(int32_t(band_top)+reach, int32_t(height))));
+        dirty.push_back(std::make_pair(std::max(int32_t(height)-reach, int32_t(band_top)), int32_t(height)));
+    }
+    std::sort(dirty.begin(), dirty.end());
+    std::vector<std::pair<int32_t, int32_t>> merged;
+    int32_t dirty_rows = 0;
+    for(const auto &i : dirty) {
+        if(i.first >= i.second)
+            continue;
+        if(!merged.empty() && i.first <= merged.back().second)
+            merged.back().second = std::max(merged.back().second, i.second);
+        else
+            merged.push_back(i);
+    }
+    for(const auto &i : merged)
+        dirty_rows += i.second-i.first;
+    /* Painting everything is cheaper than many small pieces */
+    if(dirty_rows*2 > band_rows)
+        return false;
+
+    if(shift != 0) {
+        if(!tiled) {
+            shift_rows(cairo_text_surface, shift);
+            shift_rows(cairo_blur_surface, shift);
+        }
+        shift_rows(cairo_blend_surface, shift);
+    }
+    RowPieces pieces;
+    for(const auto &i : merged)
+        if(tiled)
+            split_rows(uint32_t(i.first), uint32_t(i.second), get_tile_rows(), pieces);
+        else
+            pieces.push_back(std::make_pair(uint32_t(i.first), uint32_t(i.second)));
+    render_pieces(pieces);
+    return true;
+}
+
+void CairoRendererPrivate::shift_rows(cairo_surface_t *cairo_surface, int32_t shift) {
+    cairo_surface_flush(cairo_surface);
+    uint32_t stride = uint32_t(cairo_image_surface_get_stride(cairo_surface)/sizeof (uint32_t));
+    uint32_t *bitmap = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_surface));
+    uint32_t rows = height-band_top-uint32_t(std::abs(shift));
+    if(shift < 0)
+        std::memmove(bitmap + band_top*stride, bitmap + (band_top-shift)*stride, rows*stride*sizeof (uint32_t));
+    else
+        std::memmove(bitmap + (band_top+shift)*stride, bitmap + band_top*stride, rows*stride*sizeof (uint32_t));
+    cairo_surface_mark_dirty(cairo_surface);
+}
+
+void CairoRendererPrivate::step_clock() {
+    if(clock->is_virtual() && config::clock_step != 0)
+        clock->advance(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(config::clock_step)));
+}
+
 void CairoRendererPrivate::print_fps(std::chrono::steady_clock::time_point now) {
     fps_count++;
     if(now-fps_checkpoint > std::chrono::seconds(1)) {
@@ -245,94 +617,424 @@ void CairoRendererPrivate::print_fps(std::chrono::steady_clock::time_point now)
     }
 }
 
+/* Time to first frame, counted from the start of Application,
+   try `./live_danmaku_hime </dev/null` to measure it alone */
+void CairoRendererPrivate::print_startup_time() {
+    typedef std::chrono::duration<double, std::milli> milliseconds;
+    std::chrono::steady_clock::duration first_frame_time = std::chrono::steady_clock::now()-app->get_start_time();
+    std::cerr << "Time to first frame: " << milliseconds(first_frame_time).count() << " ms (font loading: " << milliseconds(font_load_time).count() << " ms)" << std::endl;
+}
+
 void CairoRendererPrivate::fetch_danmaku(std::chrono::steady_clock::time_point now) {
-    Fetcher *fetcher = reinterpret_cast<Fetcher *>(app->get_fetcher());
-    dmhm_assert(fetcher);
-
-    is_eof = fetcher->is_eof();
-    fetcher->pop_messages([&](DanmakuEntry &entry) {
-        DanmakuAnimator animator(entry);
-        animator.y = height-(config::extra_line_height+config::shadow_radius);
-        cairo_text_extents_t text_extents;
-        cairo_text_extents(cairo_text_layer, animator.entry.message.c_str(), &text_extents);
-        animator.height = text_extents.height+config::extra_line_height;
-        for(DanmakuAnimator &i : danmaku_list) {
-            if(i.moving) {
-                i.starty = i.starty+(i.endy-i.starty)*(now-i.starttime).count()/(i.endtime-i.starttime).count();
-                i.endy -= animator.height;
-            } else {
-                i.starty = i.y;
-                i.endy = i.starty-animator.height;
-                i.moving = true;
-            }
-            i.starttime = now;
-            i.endtime = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(config::danmaku_attack));
-        }
-        danmaku_list.push_front(std::move(animator));
+    dmhm_assert(prerasterizer);
+
+    is_eof = prerasterizer->is_eof();
+    density_governor.set_stage_height(height);
+    std::vector<DanmakuAnimator> arrivals;
+    double rise = 0;
+    prerasterizer->pop_messages([&](PreparedDanmaku &message) {
+        admit_danmaku(message.entry, std::move(message.glyph_run), arrivals, rise);
     });
+    stack_arrivals(now, arrivals, rise);
+}
+
+/* Each batch of lines with the same timestamp arrives at that time, after the lines
+   before it have been animated up to then, which is all a frame in between would do */
+void CairoRendererPrivate::fetch_timeline(std::chrono::steady_clock::time_point now) {
+    density_governor.set_stage_height(height);
+    while(timeline_cursor < timeline->size() && (*timeline)[timeline_cursor].entry.timestamp <= now) {
+        std::chrono::steady_clock::time_point arrival_time = (*timeline)[timeline_cursor].entry.timestamp;
+        animate_text(arrival_time);
+        std::vector<DanmakuAnimator> arrivals;
+        double rise = 0;
+        for(; timeline_cursor < timeline->size() && (*timeline)[timeline_cursor].entry.timestamp == arrival_time; timeline_cursor++)
+            admit_danmaku((*timeline)[timeline_cursor].entry, GlyphRun((*timeline)[timeline_cursor].glyph_run), arrivals, rise);
+        stack_arrivals(arrival_time, arrivals, rise);
+    }
+    is_eof = timeline_cursor == timeline->size();
+}
+
+void CairoRendererPrivate::admit_danmaku(const DanmakuEntry &entry, GlyphRun &&glyph_run, std::vector<DanmakuAnimator> &arrivals, double &rise) {
+    DanmakuAnimator animator(entry);
+    animator.glyph_run = std::move(glyph_run);
+    animator.height = animator.glyph_run.ink_top+animator.glyph_run.ink_bottom+config::extra_line_height;
+    if(!density_governor.admit(animator.entry.timestamp, animator.height))
+        return;
+    animator.serial = next_serial++;
+    animator.lifetime = density_governor.get_lifetime();
+    animator.y = height-(config::extra_line_height+config::shadow_radius);
+    rise += animator.height;
+    arrivals.push_back(std::move(animator));
+}
+
+void CairoRendererPrivate::stack_arrivals(std::chrono::steady_clock::time_point now, std::vector<DanmakuAnimator> &arrivals, double rise) {
+    /* Each line moves up by the height of all lines that arrived after it,
+       which takes one pass over the stack however many lines arrived */
+    std::chrono::steady_clock::time_point endtime = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(config::danmaku_attack));
+    auto move_up = [&](DanmakuAnimator &i, double distance) {
+        if(i.moving) {
+            i.starty = i.starty+(i.endy-i.starty)*(now-i.starttime).count()/(i.endtime-i.starttime).count();
+            i.endy -= distance;
+        } else {
+            i.starty = i.y;
+            i.endy = i.starty-distance;
+            i.moving = true;
+        }
+        i.starttime = now;
+        i.endtime = endtime;
+        scrolling = true;
+    };
+    if(!arrivals.empty())
+        for(DanmakuAnimator &i : danmaku_list)
+            move_up(i, rise);
+    for(size_t k = 0; k < arrivals.size(); k++) {
+        rise -= arrivals[k].height;
+        if(k+1 < arrivals.size())
+            move_up(arrivals[k], rise);
+        danmaku_list.push_front(std::move(arrivals[k]));
+        animator_index[danmaku_list.front().serial] = danmaku_list.begin();
+        fading_serials.push_back(danmaku_list.front().serial);
+        schedule_lifecycle(danmaku_list.front(), LIFECYCLE_ATTACK_END, config::danmaku_attack);
+    }
+    uint32_t evicted = 0;
+    while(danmaku_list.size() > density_governor.get_max_lines()) {
+        remove_animator(std::prev(danmaku_list.end()));
+        evicted++;
+    }
+    density_governor.count_evicted(evicted);
+}
+
+void CairoRendererPrivate::schedule_lifecycle(const DanmakuAnimator &animator, LifecycleStage stage, double seconds) {
+    LifecycleEvent event;
+    event.time = animator.entry.timestamp + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    event.serial = animator.serial;
+    event.stage = stage;
+    lifecycle_events.push(event);
+}
+
+/* Events and fading entries of a removed line are skipped when they come up */
+void CairoRendererPrivate::remove_animator(std::list<DanmakuAnimator>::iterator it) {
+    animator_index.erase(it->serial);
+    danmaku_list.erase(it);
 }
 
 void CairoRendererPrivate::animate_text(std::chrono::steady_clock::time_point now) {
-    danmaku_list.remove_if([&](const DanmakuAnimator &x) -> bool {
-        double timespan = double((now-x.entry.timestamp).count())*std::chrono::steady_clock::period::num/std::chrono::steady_clock::period::den;
-        return timespan >= config::danmaku_lifetime || x.y < -2*config::shadow_radius;
-    });
-    for(DanmakuAnimator &i : danmaku_list) {
+    uint32_t expired = 0, scrolled_out = 0;
+    while(!lifecycle_events.empty() && lifecycle_events.top().time <= now) {
+        LifecycleEvent event = lifecycle_events.top();
+        lifecycle_events.pop();
+        auto it = animator_index.find(event.serial);
+        if(it == animator_index.end())
+            continue;
+        DanmakuAnimator &i = *it->second;
+        switch(event.stage) {
+        case LIFECYCLE_ATTACK_END:
+            i.x = config::shadow_radius;
+            i.alpha = 1;
+            fading_serials.erase(std::find(fading_serials.begin(), fading_serials.end(), i.serial));
+            schedule_lifecycle(i, LIFECYCLE_DECAY_START, i.lifetime-config::danmaku_decay);
+            break;
+        case LIFECYCLE_DECAY_START:
+            fading_serials.push_back(i.serial);
+            schedule_lifecycle(i, LIFECYCLE_EXPIRE, i.lifetime);
+            break;
+        case LIFECYCLE_EXPIRE:
+            remove_animator(it->second);
+            expired++;
+            break;
+        }
+    }
+
+    fading_serials.erase(std::remove_if(fading_serials.begin(), fading_serials.end(), [&](uint64_t serial) -> bool {
+        auto it = animator_index.find(serial);
+        if(it == animator_index.end())
+            return true;
+        DanmakuAnimator &i = *it->second;
         double timespan = double((now-i.entry.timestamp).count())*std::chrono::steady_clock::period::num/std::chrono::steady_clock::period::den;
         if(timespan < config::danmaku_attack) {
             double progress = timespan/config::danmaku_attack;
             i.x = (width-config::shadow_radius)*(1-progress*(2-progress))+config::shadow_radius;
             i.alpha = progress;
-        } else if(timespan < config::danmaku_lifetime-config::danmaku_decay) {
-            i.x = config::shadow_radius;
-            i.alpha = 1;
         } else {
             i.x = config::shadow_radius;
-            i.alpha = (config::danmaku_lifetime-timespan)/config::danmaku_decay;
+            i.alpha = (i.lifetime-timespan)/config::danmaku_decay;
         }
-        if(i.moving)
-            if(now >= i.endtime) {
-                i.moving = false;
-                i.y = i.endy;
-            } else
-                i.y = i.starty+(i.endy-i.starty)*(now-i.starttime).count()/(i.endtime-i.starttime).count();
-        else;
+        return false;
+    }), fading_serials.end());
+
+    /* Every arrival moves all lines up together, they only leave the top while doing so */
+    if(scrolling) {
+        scrolling = false;
+        for(auto it = danmaku_list.begin(); it != danmaku_list.end();) {
+            DanmakuAnimator &i = *it++;
+            if(i.moving) {
+                if(now >= i.endtime) {
+                    i.moving = false;
+                    i.y = i.endy;
+                } else {
+                    i.y = i.starty+(i.endy-i.starty)*(now-i.starttime).count()/(i.endtime-i.starttime).count();
+                    scrolling = true;
+                }
+            }
+            if(i.y < -2*config::shadow_radius) {
+                remove_animator(std::prev(it));
+                scrolled_out++;
+            }
+        }
+    }
+    density_governor.count_expired(expired);
+    density_governor.count_scrolled_out(scrolled_out);
+}
+
+CairoRendererPrivate::LayerBitmaps CairoRendererPrivate::begin_layers() {
+    LayerBitmaps layers = {nullptr, 0, nullptr, 0, nullptr, 0};
+    if(!tiled) {
+        cairo_surface_flush(cairo_text_surface);
+        layers.text = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_text_surface));
+        layers.text_stride = uint32_t(cairo_image_surface_get_stride(cairo_text_surface)/sizeof (uint32_t));
+        cairo_surface_flush(cairo_blur_surface);
+        layers.blur = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_blur_surface));
+        layers.blur_stride = uint32_t(cairo_image_surface_get_stride(cairo_blur_surface)/sizeof (uint32_t));
     }
+    cairo_surface_flush(cairo_blend_surface);
+    layers.blend = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_blend_surface));
+    layers.blend_stride = uint32_t(cairo_image_surface_get_stride(cairo_blend_surface)/sizeof (uint32_t));
+    return layers;
+}
+
+void CairoRendererPrivate::end_layers() {
+    if(!tiled) {
+        cairo_surface_mark_dirty(cairo_text_surface);
+        cairo_surface_mark_dirty(cairo_blur_surface);
+    }
+    cairo_surface_mark_dirty(cairo_blend_surface);
 }
 
-void CairoRendererPrivate::paint_text() {
+/* Pieces overlap by the blur reach, so they should be a few times larger than it */
+void CairoRendererPrivate::render_band() {
+    uint32_t rows = height-band_top;
+    uint32_t threads = thread_pool->size();
+    uint32_t piece_rows = rows;
+    if(tiled)
+        piece_rows = get_tile_rows();
+    else if(threads > 1)
+        piece_rows = std::max((rows + threads*2-1) / (threads*2), std::max(blur_reach()*4, uint32_t(32)));
+    RowPieces pieces;
+    split_rows(band_top, height, piece_rows, pieces);
+    render_pieces(pieces);
+}
+
+/* The last piece takes the rest, a piece much thinner than the blur reach would not blur right */
+void CairoRendererPrivate::split_rows(uint32_t top, uint32_t bottom, uint32_t piece_rows, RowPieces &pieces) {
+    for(uint32_t i = top; i < bottom; i += piece_rows)
+        if(bottom-i < piece_rows*2) {
+            pieces.push_back(std::make_pair(i, bottom));
+            break;
+        } else
+            pieces.push_back(std::make_pair(i, i+piece_rows));
+}
+
+/* Text of all pieces is painted before any of it is blurred,
+   because a piece reads the text of its neighbors within the blur reach */
+void CairoRendererPrivate::render_pieces(const RowPieces &pieces) {
+    LayerBitmaps layers = begin_layers();
+    if(shadow_engine == SHADOW_ENGINE_STAMP) {
+        /* Look up all stamps here, the cache is not shared between threads */
+        shadow_stamps->trim();
+        for(const DanmakuAnimator &i : danmaku_list)
+            for(const GlyphRun::Item &item : i.glyph_run.items)
+                shadow_stamps->get_stamp(item.glyph);
+    }
+    if(piece_workspace.size() < pieces.size())
+        piece_workspace.resize(pieces.size());
+    if(tiled) {
+        thread_pool->parallel_for(uint32_t(pieces.size()), [&](uint32_t index) {
+            render_tile(layers, pieces[index].first, pieces[index].second, piece_workspace[index]);
+        });
+        end_layers();
+        return;
+    }
+    thread_pool->parallel_for(uint32_t(pieces.size()), [&](uint32_t index) {
+        paint_text(layers, pieces[index].first, pieces[index].second);
+    });
+    if(shadow_downsample == 1 && shadow_engine != SHADOW_ENGINE_IIR) {
+        thread_pool->parallel_for(uint32_t(pieces.size()), [&](uint32_t index) {
+            blur_rows(layers, pieces[index].first, pieces[index].second, piece_workspace[index]);
+            blend_rows(layers, pieces[index].first, pieces[index].second);
+        });
+    } else {
+        /* No finite reach, only called for the whole band */
+        blur_band(layers);
+        thread_pool->parallel_for(uint32_t(pieces.size()), [&](uint32_t index) {
+            blend_rows(layers, pieces[index].first, pieces[index].second);
+        });
+    }
+    end_layers();
+}
+
+void CairoRendererPrivate::paint_text(const LayerBitmaps &layers, uint32_t top, uint32_t bottom) {
+    std::fill(layers.text + top*layers.text_stride, layers.text + bottom*layers.text_stride, 0);
+    for(const DanmakuAnimator &i : danmaku_list)
+        paint_glyph_run(layers.text + top*layers.text_stride, layers.text_stride, int32_t(width), int32_t(top), int32_t(bottom), i.glyph_run, i.x, i.y, i.alpha);
+}
+
+/* Composite white text OVER the premultiplied ARGB32 bitmap, which holds rows from clip_top to clip_bottom,
+   glyphs are snapped to whole pixels like Cairo image surfaces do */
+void CairoRendererPrivate::paint_glyph_run(uint32_t *bitmap, uint32_t stride, int32_t width, int32_t clip_top, int32_t clip_bottom, const GlyphRun &run, double x, double y, double alpha) {
+    uint32_t alpha_fixed = uint32_t(std::min(std::max(alpha, 0.0), 1.0)*256);
+    if(alpha_fixed == 0)
+        return;
+    int32_t baseline = int32_t(std::lround(y));
+    for(const GlyphRun::Item &item : run.items) {
+        const Glyph *glyph = item.glyph;
+        int32_t left = int32_t(std::lround(x + item.pen_x/64.0)) + glyph->left;
+        int32_t top = baseline - glyph->top;
+        int32_t row_start = std::max(0, clip_top-top);
+        int32_t row_end = std::min(int32_t(glyph->height), clip_bottom-top);
+        int32_t col_start = std::max(0, -left);
+        int32_t col_end = std::min(int32_t(glyph->width), width-left);
+        for(int32_t i = row_start; i < row_end; i++) {
+            const uint8_t *src = glyph->bitmap + i*glyph->width;
+            uint32_t *dst = bitmap + (top+i-clip_top)*stride + left;
+            for(int32_t j = col_start; j < col_end; j++) {
+                uint32_t src_alpha = (src[j]*alpha_fixed) >> 8;
+                if(src_alpha == 0)
+                    continue;
+                uint32_t dst_alpha = dst[j] >> 24;
+                uint32_t out_alpha = src_alpha + (dst_alpha*(255-src_alpha) + 127)/255;
+                dst[j] = out_alpha * 0x01010101;
+            }
+        }
+    }
+}
+
+/* Same glyph placement as paint_glyph_run, the bitmap holds rows from top to bottom */
+void CairoRendererPrivate::paint_shadow_stamps(uint32_t *bitmap, uint32_t stride, uint32_t top, uint32_t bottom) {
     for(const DanmakuAnimator &i : danmaku_list) {
-        cairo_move_to(cairo_text_layer, i.x, i.y);
-        cairo_set_source_rgba(cairo_text_layer, 1, 1, 1, i.alpha);
-        cairo_show_text(cairo_text_layer, i.entry.message.c_str());
+        uint32_t alpha_fixed = uint32_t(std::min(std::max(i.alpha, 0.0), 1.0)*256);
+        if(alpha_fixed == 0)
+            continue;
+        int32_t baseline = int32_t(std::lround(i.y));
+        for(const GlyphRun::Item &item : i.glyph_run.items) {
+            const ShadowStamp *stamp = shadow_stamps->get_stamp(item.glyph);
+            if(stamp->width == 0)
+                continue;
+            int32_t left = int32_t(std::lround(i.x + item.pen_x/64.0)) + stamp->left;
+            int32_t stamp_top = baseline - stamp->top - int32_t(top);
+            shadow_stamps->accumulate(bitmap, stride, int32_t(width), int32_t(bottom-top), *stamp, left, stamp_top, alpha_fixed);
+        }
     }
 }
 
-void CairoRendererPrivate::blend_layers() {
-    cairo_surface_flush(cairo_text_surface);
-    const uint32_t *text_bitmap = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_text_surface));
-    uint32_t text_stride = uint32_t(cairo_image_surface_get_stride(cairo_text_surface)/sizeof (uint32_t));
-    cairo_surface_flush(cairo_blur_surface);
-    uint32_t *blur_bitmap = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_blur_surface));
-    uint32_t blur_stride = uint32_t(cairo_image_surface_get_stride(cairo_blur_surface)/sizeof (uint32_t));
-    cairo_surface_flush(cairo_blend_surface);
-    uint32_t *blend_bitmap = reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(cairo_blend_surface));
-    uint32_t blend_stride = uint32_t(cairo_image_surface_get_stride(cairo_blend_surface)/sizeof (uint32_t));
+/* Box blur of rows from top to bottom, with enough rows around that the edge of the piece does not show */
+void CairoRendererPrivate::blur_rows(const LayerBitmaps &layers, uint32_t top, uint32_t bottom, PieceWorkspace &workspace) {
+    if(shadow_engine == SHADOW_ENGINE_STAMP) {
+        std::fill(layers.blur + top*layers.blur_stride, layers.blur + bottom*layers.blur_stride, 0);
+        paint_shadow_stamps(layers.blur + top*layers.blur_stride, layers.blur_stride, top, bottom);
+        return;
+    }
+    uint32_t stride = layers.blur_stride;
+    uint32_t context_top = std::max(top, band_top+blur_reach())-blur_reach();
+    uint32_t context_bottom = std::min(bottom+blur_reach(), height);
+    uint32_t context_rows = context_bottom-context_top;
+    workspace.planes.resize(size_t(context_rows)*stride*2);
+    uint32_t *context = workspace.planes.data();
+    for(uint32_t i = 0; i < context_rows; i++)
+        for(uint32_t j = 0; j < width; j++)
+            context[i*stride + j] = layers.text[(context_top+i)*layers.text_stride + j] >> 24;
+    filter_shadow(context, context + size_t(context_rows)*stride, int32_t(stride), int32_t(context_rows), workspace.filter);
+    std::copy(context + (top-context_top)*stride, context + (bottom-context_top)*stride, layers.blur + top*stride);
+}
+
+/* The IIR engine and reduced resolution shadows, on the whole band */
+void CairoRendererPrivate::blur_band(const LayerBitmaps &layers) {
+    uint32_t rows = height-band_top;
+    const uint32_t *text_bitmap = layers.text + band_top*layers.text_stride;
+    uint32_t *blur_bitmap = layers.blur + band_top*layers.blur_stride;
+    if(shadow_downsample > 1)
+        blur_downsampled(text_bitmap, layers.text_stride, blur_bitmap, layers.blur_stride, rows);
+    else {
+        for(uint32_t i = 0; i < rows; i++)
+            for(uint32_t j = 0; j < width; j++)
+                blur_bitmap[i*layers.blur_stride + j] = text_bitmap[i*layers.text_stride + j] >> 24;
+        gauss_blur_iir(blur_bitmap, int32_t(layers.blur_stride), int32_t(rows), blur_sigma, blur_workspace);
+    }
+}
 
-    dmhm_assert(blur_stride == blend_stride);
+void CairoRendererPrivate::blend_rows(const LayerBitmaps &layers, uint32_t top, uint32_t bottom) {
+    for(uint32_t i = top; i < bottom; i++)
+        blend_row(layers.text + i*layers.text_stride, layers.blur + i*layers.blur_stride, layers.blend + i*layers.blend_stride);
+}
 
-    for(uint32_t i = 0; i < height; i++)
+/* Shadow through the gamma table, then text on top */
+void CairoRendererPrivate::blend_row(const uint32_t *text, const uint32_t *blur, uint32_t *blend) {
+    if(shadow_engine == SHADOW_ENGINE_STAMP)
         for(uint32_t j = 0; j < width; j++)
-            blur_bitmap[i*blend_stride + j] = text_bitmap[i*text_stride + j] >> 24;
-    gauss_blur(blur_bitmap, blend_bitmap, blend_stride, height);
-    for(uint32_t i = 0; i < height; i++)
+            blend[j] = composite_over(text[j], gamma_table[std::min(blur[j] >> 8, uint32_t(255))]);
+    else
         for(uint32_t j = 0; j < width; j++)
-            blend_bitmap[i*blend_stride + j] = gamma_table[blur_bitmap[i*blur_stride + j]];
+            blend[j] = composite_over(text[j], gamma_table[blur[j]]);
+}
 
-    cairo_surface_mark_dirty(cairo_blur_surface);
-    cairo_surface_mark_dirty(cairo_blend_surface);
-    cairo_set_source_surface(cairo_blend_layer, cairo_text_surface, 0, 0);
-    cairo_paint(cairo_blend_layer);
+/* Text within the blur reach around the tile is painted again for each tile, instead of being kept in a layer */
+void CairoRendererPrivate::render_tile(const LayerBitmaps &layers, uint32_t top, uint32_t bottom, PieceWorkspace &workspace) {
+    uint32_t reach = shadow_engine == SHADOW_ENGINE_STAMP ? 0 : blur_reach();
+    uint32_t context_top = std::max(top, band_top+reach)-reach;
+    uint32_t context_bottom = std::min(bottom+reach, height);
+    size_t plane_size = size_t(context_bottom-context_top)*width;
+    workspace.planes.resize(plane_size*3);
+    uint32_t *text = workspace.planes.data();
+    uint32_t *blur = text + plane_size;
+
+    std::fill(text, text + plane_size, 0);
+    for(const DanmakuAnimator &i : danmaku_list)
+        paint_glyph_run(text, width, int32_t(width), int32_t(context_top), int32_t(context_bottom), i.glyph_run, i.x, i.y, i.alpha);
+    if(shadow_engine == SHADOW_ENGINE_STAMP) {
+        std::fill(blur, blur + plane_size, 0);
+        paint_shadow_stamps(blur, width, top, bottom);
+    } else {
+        for(size_t i = 0; i < plane_size; i++)
+            blur[i] = text[i] >> 24;
+        filter_shadow(blur, blur + plane_size, int32_t(width), int32_t(context_bottom-context_top), workspace.filter);
+    }
+    for(uint32_t i = top; i < bottom; i++)
+        blend_row(text + (i-context_top)*width, blur + (i-context_top)*width, layers.blend + i*layers.blend_stride);
+}
+
+/* Rows per tile, so that the three planes of a tile fit in tile_cache_size KiB */
+uint32_t CairoRendererPrivate::get_tile_rows() const {
+    uint32_t reach = blur_reach();
+    uint32_t rows = uint32_t(uint64_t(config::tile_cache_size)*1024 / (uint64_t(width)*sizeof (uint32_t)*3));
+    return std::max(rows > reach*2 ? rows-reach*2 : 0, reach*2+16);
+}
+
+/* Premultiplied OVER, rounded like pixman so the result matches cairo_paint */
+uint32_t CairoRendererPrivate::composite_over(uint32_t src, uint32_t dst) {
+    uint32_t src_alpha = src >> 24;
+    if(src_alpha == 0)
+        return dst;
+    if(src_alpha == 255)
+        return src;
+    uint32_t inverse_alpha = 255-src_alpha;
+    uint32_t result = 0;
+    for(uint32_t shift = 0; shift < 32; shift += 8) {
+        uint32_t t = ((dst >> shift) & 0xff)*inverse_alpha + 0x80;
+        result |= (((src >> shift) & 0xff) + (((t >> 8) + t) >> 8)) << shift;
+    }
+    return result;
+}
+
+void CairoRendererPrivate::blur_downsampled(const uint32_t *text_bitmap, uint32_t text_stride, uint32_t *blur_bitmap, uint32_t blur_stride, uint32_t rows) {
+    int32_t small_width = int32_t((width + shadow_downsample-1) / shadow_downsample);
+    int32_t small_height = int32_t((rows + shadow_downsample-1) / shadow_downsample);
+    small_blur_bitmap.resize(size_t(small_width)*small_height);
+    small_blur_temp.resize(small_blur_bitmap.size());
+    downsample_alpha(text_bitmap, text_stride, int32_t(width), int32_t(rows), small_blur_bitmap.data(), uint32_t(small_width), shadow_downsample);
+    if(shadow_engine == SHADOW_ENGINE_IIR)
+        gauss_blur_iir(small_blur_bitmap.data(), small_width, small_height, blur_sigma, blur_workspace);
+    else
+        filter_shadow(small_blur_bitmap.data(), small_blur_temp.data(), small_width, small_height, small_filter_workspace);
+    upsample_bilinear(small_blur_bitmap.data(), uint32_t(small_width), small_width, small_height, blur_bitmap, blur_stride, int32_t(width), int32_t(rows), shadow_downsample);
 }
 
 void CairoRendererPrivate::generate_blur_boxes() {
@@ -341,83 +1043,71 @@ void CairoRendererPrivate::generate_blur_boxes() {
         gamma_table[i] = uint32_t((1-(1-fi)*(1-fi))*double(0xff000000)) & 0xff000000;
     }
 
-    const uint32_t n = blur_rounds;
     dmhm_assert(config::shadow_radius >= 0);
-    double sigma = config::shadow_radius/3;
-
-    double wIdeal = std::sqrt(12*sigma*sigma/n+1);
-    uint32_t wl = std::floor(wIdeal);
-    if((wl & 1) == 0)
-        wl--;
-    uint32_t wu = wl+2;
-    double mIdeal = (12*sigma*sigma - n*wl*wl - 4*n*wl - 3*n)/(-4*wl - 4);
-    uint32_t m = uint32_t(mIdeal);
-
-    for(uint32_t i = 0; i < n; i++)
-        blur_boxes[i] = i<m ? wl : wu;
-}
-
-/* Thanks to http://blog.ivank.net/fastest-gaussian-blur.html
-   I rewrote the original algorithm in C++*/
-void CairoRendererPrivate::gauss_blur(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h) {
-    const uint32_t *bxs = blur_boxes;
-    box_blur(scl, tcl, w, h, int32_t((bxs[0]-1)/2));
-    box_blur(tcl, scl, w, h, int32_t((bxs[1]-1)/2));
-    // box_blur(scl, tcl, w, h, int32_t((bxs[2]-1)/2)); // Two times are enough, the result is in scl instead
-}
-
-void CairoRendererPrivate::box_blur(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r) {
-    for(int32_t i = 0; i < w*h; i++)
-        tcl[i] = scl[i];
-    box_blur_H(tcl, scl, w, h, r);
-    box_blur_T(scl, tcl, w, h, r);
-}
-
-void CairoRendererPrivate::box_blur_H(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r) {
-    uint32_t iarr = r*2+1;
-    for(int32_t i = 0; i < h; i++) {
-        int32_t ti = i*w, li = ti, ri = ti+r;
-        uint32_t fv = scl[ti], lv = scl[ti+w-1], val = (r+1)*fv;
-        for(int32_t j = 0; j < r; j++)
-            val += scl[ti+j];
-        for(int32_t j = 0; j <= r; j++) {
-            val += scl[ri++] - fv;
-            tcl[ti++] = val/iarr;
-        }
-        for(int32_t j = r+1; j < w-r; j++) {
-            val += scl[ri++] - scl[li++];
-            tcl[ti++] = val/iarr;
-        }
-        for(int32_t j = w-r; j < w; j++) {
-            val += lv - scl[li++];
-            tcl[ti++] = val/iarr;
-        }
+    blur_sigma = config::shadow_radius*radius_scale/3/shadow_downsample;
+    compute_blur_boxes(blur_sigma, blur_boxes, blur_rounds);
+    outline_radius = compute_outline_radius(blur_sigma);
+    if(shadow_engine == SHADOW_ENGINE_STAMP)
+        shadow_stamps.reset(new ShadowStampCache(blur_boxes));
+}
+
+/* Each tier adds one saving to the one before, steps that change nothing for the engine are left out */
+std::vector<QualityTier> CairoRendererPrivate::get_quality_tiers() const {
+    std::vector<QualityTier> tiers;
+    /* Stamps are blurred once per glyph, there is nothing to gain from reduced resolution */
+    QualityTier tier = { "full quality", blur_box_rounds, shadow_engine == SHADOW_ENGINE_STAMP ? 1 : config::shadow_downsample, 1, 1 };
+    tiers.push_back(tier);
+    if(shadow_engine == SHADOW_ENGINE_BOX || shadow_engine == SHADOW_ENGINE_STAMP) {
+        tier.name = "one blur round";
+        tier.blur_rounds = 1;
+        tiers.push_back(tier);
+    }
+    if(shadow_engine != SHADOW_ENGINE_STAMP && tier.shadow_downsample < 2) {
+        tier.name = "half resolution shadow";
+        tier.shadow_downsample = 2;
+        tiers.push_back(tier);
     }
+    tier.name = "half frame rate";
+    tier.frame_interval = 2;
+    tiers.push_back(tier);
+    tier.name = "half shadow radius";
+    tier.radius_scale = 0.5;
+    tiers.push_back(tier);
+    return tiers;
 }
 
-void CairoRendererPrivate::box_blur_T(uint32_t *scl, uint32_t *tcl, int32_t w, int32_t h, int32_t r) {
-    uint32_t iarr = r*2+1;
-    for(int32_t i = 0; i < w; i++) {
-        int32_t ti = i, li = ti, ri = ti+r*w;
-        uint32_t fv = scl[ti], lv = scl[ti+w*(h-1)], val = (r+1)*fv;
-        for(int32_t j = 0; j < r; j++)
-            val += scl[ti+j*w];
-        for(int32_t j = 0; j <= r; j++) {
-            val += scl[ri] - fv;
-            tcl[ti] = val/iarr;
-            ri += w; ti += w;
-        }
-        for(int32_t j = r+1; j < h-r; j++) {
-            val += scl[ri] - scl[li];
-            tcl[ti] = val/iarr;
-            li += w; ri += w; ti += w;
-        }
-        for(int32_t j = h-r; j < h; j++) {
-            val += lv - scl[li];
-            tcl[ti] = val/iarr;
-            li += w; ti += w;
-        }
+void CairoRendererPrivate::apply_quality(const QualityTier &tier) {
+    blur_rounds = tier.blur_rounds;
+    shadow_downsample = tier.shadow_downsample;
+    frame_interval = tier.frame_interval;
+    radius_scale = tier.radius_scale;
+    generate_blur_boxes();
+    /* The IIR engine and reduced resolution shadows need the whole band at once */
+    tiled = config::tile_cache_size != 0 && shadow_downsample == 1 && shadow_engine != SHADOW_ENGINE_IIR;
+    if(tiled) {
+        release_cairo(cairo_text_surface, cairo_text_layer);
+        release_cairo(cairo_blur_surface, cairo_blur_layer);
     }
+    frame_reusable = false;
+}
+
+void CairoRendererPrivate::filter_shadow(uint32_t *plane, uint32_t *temp, int32_t w, int32_t h, std::vector<uint32_t> &workspace) {
+    if(shadow_engine == SHADOW_ENGINE_OUTLINE || shadow_engine == SHADOW_ENGINE_SOFT_OUTLINE)
+        outline_alpha(plane, temp, w, h, outline_radius, shadow_engine == SHADOW_ENGINE_SOFT_OUTLINE, workspace);
+    else
+        gauss_blur_box(plane, temp, w, h, blur_boxes);
+}
+
+/* How many rows away the box blur or the outline takes input from */
+uint32_t CairoRendererPrivate::blur_reach() const {
+    if(shadow_engine == SHADOW_ENGINE_OUTLINE)
+        return outline_radius;
+    if(shadow_engine == SHADOW_ENGINE_SOFT_OUTLINE)
+        return outline_radius+1;
+    uint32_t reach = 0;
+    for(uint32_t i = 0; i < blur_box_rounds; i++)
+        reach += (blur_boxes[i]-1)/2;
+    return reach;
 }
 
 }
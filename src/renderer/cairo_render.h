@@ -21,7 +21,9 @@
 
 #include "../utils.h"
 #include "../app.h"
+#include <chrono>
 #include <functional>
+#include <vector>
 
 namespace dmhm {
 
@@ -30,8 +32,21 @@ class CairoRenderer {
 public:
 
     CairoRenderer(Application *app);
+    /* Paints a recorded timeline with paint_frame_at instead, with no fetcher, presenter
+       or fonts of its own. The timeline is ordered by timestamp and must outlive the renderer */
+    CairoRenderer(const std::vector<struct PreparedDanmaku> &timeline, uint32_t render_threads = 1);
     ~CairoRenderer();
-    bool paint_frame(uint32_t width, uint32_t height, std::function<void (const uint32_t *bitmap, uint32_t stride)> callback);
+    void wait_ready();
+    /* The bitmap covers the whole stage, only rows in the band may be non-transparent */
+    bool paint_frame(uint32_t width, uint32_t height, std::function<void (const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height)> callback);
+    /* Paint frames straight into memory of the presenter, such as shared memory with the display server.
+       It must hold a whole stage of stride pixels per row, stay untouched between frames,
+       and stay valid until it is replaced or reset by nullptr */
+    void set_frame_buffer(uint32_t *bitmap, uint32_t stride);
+    /* Paints the timeline as it stands at time, which never goes backwards.
+       Lines arrive at their own timestamps rather than at the next frame, so the
+       picture at any time is the same however many frames were painted before */
+    bool paint_frame_at(uint32_t width, uint32_t height, std::chrono::steady_clock::time_point time, std::function<void (const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height)> callback);
 
 private:
 
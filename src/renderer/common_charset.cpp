@@ -0,0 +1,103 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "glyph_cache.h"
+
+namespace dmhm {
+
+/* Commonly used Chinese characters, roughly in descending order of frequency.
+   Glyphs for ASCII and these are rasterized ahead of time. */
+const char *const common_charset =
+    "\xe7\x9a\x84\xe4\xb8\x80\xe6\x98\xaf\xe4\xb8\x8d\xe4\xba\x86\xe5\x9c\xa8\xe4\xba\xba\xe6\x9c\x89\xe6\x88\x91\xe4\xbb\x96\xe8\xbf\x99\xe4\xb8\xaa\xe4\xbb\xac\xe4\xb8\xad\xe6\x9d\xa5\xe4\xb8\x8a"
+    "\xe5\xa4\xa7\xe4\xb8\xba\xe5\x92\x8c\xe5\x9b\xbd\xe5\x9c\xb0\xe5\x88\xb0\xe4\xbb\xa5\xe8\xaf\xb4\xe6\x97\xb6\xe8\xa6\x81\xe5\xb0\xb1\xe5\x87\xba\xe4\xbc\x9a\xe5\x8f\xaf\xe4\xb9\x9f\xe4\xbd\xa0"
+    "\xe5\xaf\xb9\xe7\x94\x9f\xe8\x83\xbd\xe8\x80\x8c\xe5\xad\x90\xe9\x82\xa3\xe5\xbe\x97\xe4\xba\x8e\xe7\x9d\x80\xe4\xb8\x8b\xe8\x87\xaa\xe4\xb9\x8b\xe5\xb9\xb4\xe8\xbf\x87\xe5\x8f\x91\xe5\x90\x8e"
+    "\xe4\xbd\x9c\xe9\x87\x8c\xe7\x94\xa8\xe9\x81\x93\xe8\xa1\x8c\xe6\x89\x80\xe7\x84\xb6\xe5\xae\xb6\xe7\xa7\x8d\xe4\xba\x8b\xe6\x88\x90\xe6\x96\xb9\xe5\xa4\x9a\xe7\xbb\x8f\xe4\xb9\x88\xe5\x8e\xbb"
+    "\xe6\xb3\x95\xe5\xad\xa6\xe5\xa6\x82\xe9\x83\xbd\xe5\x90\x8c\xe7\x8e\xb0\xe5\xbd\x93\xe6\xb2\xa1\xe5\x8a\xa8\xe9\x9d\xa2\xe8\xb5\xb7\xe7\x9c\x8b\xe5\xae\x9a\xe5\xa4\xa9\xe5\x88\x86\xe8\xbf\x98"
+    "\xe8\xbf\x9b\xe5\xa5\xbd\xe5\xb0\x8f\xe9\x83\xa8\xe5\x85\xb6\xe4\xba\x9b\xe4\xb8\xbb\xe6\xa0\xb7\xe7\x90\x86\xe5\xbf\x83\xe5\xa5\xb9\xe6\x9c\xac\xe5\x89\x8d\xe5\xbc\x80\xe4\xbd\x86\xe5\x9b\xa0"
+    "\xe5\x8f\xaa\xe4\xbb\x8e\xe6\x83\xb3\xe5\xae\x9e\xe6\x97\xa5\xe5\x86\x9b\xe8\x80\x85\xe6\x84\x8f\xe6\x97\xa0\xe5\x8a\x9b\xe5\xae\x83\xe4\xb8\x8e\xe9\x95\xbf\xe6\x8a\x8a\xe6\x9c\xba\xe5\x8d\x81"
+    "\xe6\xb0\x91\xe7\xac\xac\xe5\x85\xac\xe6\xad\xa4\xe5\xb7\xb2\xe5\xb7\xa5\xe4\xbd\xbf\xe6\x83\x85\xe6\x98\x8e\xe6\x80\xa7\xe7\x9f\xa5\xe5\x85\xa8\xe4\xb8\x89\xe5\x8f\x88\xe5\x85\xb3\xe7\x82\xb9"
+    "\xe6\xad\xa3\xe4\xb8\x9a\xe5\xa4\x96\xe5\xb0\x86\xe4\xb8\xa4\xe9\xab\x98\xe9\x97\xb4\xe7\x94\xb1\xe9\x97\xae\xe5\xbe\x88\xe6\x9c\x80\xe9\x87\x8d\xe5\xb9\xb6\xe7\x89\xa9\xe6\x89\x8b\xe5\xba\x94"
+    "\xe6\x88\x98\xe5\x90\x91\xe5\xa4\xb4\xe6\x96\x87\xe4\xbd\x93\xe6\x94\xbf\xe7\xbe\x8e\xe7\x9b\xb8\xe8\xa7\x81\xe8\xa2\xab\xe5\x88\xa9\xe4\xbb\x80\xe4\xba\x8c\xe7\xad\x89\xe4\xba\xa7\xe6\x88\x96"
+    "\xe6\x96\xb0\xe5\xb7\xb1\xe5\x88\xb6\xe8\xba\xab\xe6\x9e\x9c\xe5\x8a\xa0\xe8\xa5\xbf\xe6\x96\xaf\xe6\x9c\x88\xe8\xaf\x9d\xe5\x90\x88\xe5\x9b\x9e\xe7\x89\xb9\xe4\xbb\xa3\xe5\x86\x85\xe4\xbf\xa1"
+    "\xe8\xa1\xa8\xe5\x8c\x96\xe8\x80\x81\xe7\xbb\x99\xe4\xb8\x96\xe4\xbd\x8d\xe6\xac\xa1\xe5\xba\xa6\xe9\x97\xa8\xe4\xbb\xbb\xe5\xb8\xb8\xe5\x85\x88\xe6\xb5\xb7\xe9\x80\x9a\xe6\x95\x99\xe5\x84\xbf"
+    "\xe5\x8e\x9f\xe4\xb8\x9c\xe5\xa3\xb0\xe6\x8f\x90\xe7\xab\x8b\xe5\x8f\x8a\xe6\xaf\x94\xe5\x91\x98\xe8\xa7\xa3\xe6\xb0\xb4\xe5\x90\x8d\xe7\x9c\x9f\xe8\xae\xba\xe5\xa4\x84\xe8\xb5\xb0\xe4\xb9\x89"
+    "\xe5\x90\x84\xe5\x85\xa5\xe5\x87\xa0\xe5\x8f\xa3\xe8\xae\xa4\xe6\x9d\xa1\xe5\xb9\xb3\xe7\xb3\xbb\xe6\xb0\x94\xe9\xa2\x98\xe6\xb4\xbb\xe5\xb0\x94\xe6\x9b\xb4\xe5\x88\xab\xe6\x89\x93\xe5\xa5\xb3"
+    "\xe5\x8f\x98\xe5\x9b\x9b\xe7\xa5\x9e\xe6\x80\xbb\xe4\xbd\x95\xe7\x94\xb5\xe6\x95\xb0\xe5\xae\x89\xe5\xb0\x91\xe6\x8a\xa5\xe6\x89\x8d\xe7\xbb\x93\xe5\x8f\x8d\xe5\x8f\x97\xe7\x9b\xae\xe5\xa4\xaa"
+    "\xe9\x87\x8f\xe5\x86\x8d\xe6\x84\x9f\xe5\xbb\xba\xe5\x8a\xa1\xe5\x81\x9a\xe6\x8e\xa5\xe5\xbf\x85\xe5\x9c\xba\xe4\xbb\xb6\xe8\xae\xa1\xe7\xae\xa1\xe6\x9c\x9f\xe5\xb8\x82\xe7\x9b\xb4\xe5\xbe\xb7"
+    "\xe8\xb5\x84\xe5\x91\xbd\xe5\xb1\xb1\xe9\x87\x91\xe6\x8c\x87\xe5\x85\x8b\xe8\xae\xb8\xe7\xbb\x9f\xe5\x8c\xba\xe4\xbf\x9d\xe8\x87\xb3\xe9\x98\x9f\xe5\xbd\xa2\xe7\xa4\xbe\xe4\xbe\xbf\xe7\xa9\xba"
+    "\xe5\x86\xb3\xe6\xb2\xbb\xe5\xb1\x95\xe9\xa9\xac\xe7\xa7\x91\xe5\x8f\xb8\xe4\xba\x94\xe5\x9f\xba\xe7\x9c\xbc\xe4\xb9\xa6\xe9\x9d\x9e\xe5\x88\x99\xe5\x90\xac\xe7\x99\xbd\xe5\x8d\xb4\xe7\x95\x8c"
+    "\xe8\xbe\xbe\xe5\x85\x89\xe6\x94\xbe\xe5\xbc\xba\xe5\x8d\xb3\xe5\x83\x8f\xe9\x9a\xbe\xe4\xb8\x94\xe6\x9d\x83\xe6\x80\x9d\xe7\x8e\x8b\xe8\xb1\xa1\xe5\xae\x8c\xe8\xae\xbe\xe5\xbc\x8f\xe8\x89\xb2"
+    "\xe8\xb7\xaf\xe8\xae\xb0\xe5\x8d\x97\xe5\x93\x81\xe4\xbd\x8f\xe5\x91\x8a\xe7\xb1\xbb\xe6\xb1\x82\xe6\x8d\xae\xe7\xa8\x8b\xe5\x8c\x97\xe8\xbe\xb9\xe6\xad\xbb\xe5\xbc\xa0\xe8\xaf\xa5\xe4\xba\xa4"
+    "\xe8\xa7\x84\xe4\xb8\x87\xe5\x8f\x96\xe6\x8b\x89\xe6\xa0\xbc\xe6\x9c\x9b\xe8\xa7\x89\xe6\x9c\xaf\xe9\xa2\x86\xe5\x85\xb1\xe7\xa1\xae\xe4\xbc\xa0\xe5\xb8\x88\xe8\xa7\x82\xe6\xb8\x85\xe4\xbb\x8a"
+    "\xe5\x88\x87\xe9\x99\xa2\xe8\xae\xa9\xe8\xaf\x86\xe5\x80\x99\xe5\xb8\xa6\xe5\xaf\xbc\xe4\xba\x89\xe8\xbf\x90\xe7\xac\x91\xe9\xa3\x9e\xe9\xa3\x8e\xe6\xad\xa5\xe6\x94\xb9\xe6\x94\xb6\xe6\xa0\xb9"
+    "\xe5\xb9\xb2\xe9\x80\xa0\xe8\xa8\x80\xe8\x81\x94\xe6\x8c\x81\xe7\xbb\x84\xe6\xaf\x8f\xe6\xb5\x8e\xe8\xbd\xa6\xe4\xba\xb2\xe6\x9e\x81\xe6\x9e\x97\xe6\x9c\x8d\xe5\xbf\xab\xe5\x8a\x9e\xe8\xae\xae"
+    "\xe5\xbe\x80\xe5\x85\x83\xe8\x8b\xb1\xe5\xa3\xab\xe8\xaf\x81\xe8\xbf\x91\xe5\xa4\xb1\xe8\xbd\xac\xe5\xa4\xab\xe4\xbb\xa4\xe5\x87\x86\xe5\xb8\x83\xe5\xa7\x8b\xe6\x80\x8e\xe5\x91\xa2\xe5\xad\x98"
+    "\xe6\x9c\xaa\xe8\xbf\x9c\xe5\x8f\xab\xe5\x8f\xb0\xe5\x8d\x95\xe5\xbd\xb1\xe5\x85\xb7\xe7\xbd\x97\xe5\xad\x97\xe7\x88\xb1\xe5\x87\xbb\xe6\xb5\x81\xe5\xa4\x87\xe5\x85\xb5\xe8\xbf\x9e\xe8\xb0\x83"
+    "\xe6\xb7\xb1\xe5\x95\x86\xe7\xae\x97\xe8\xb4\xa8\xe5\x9b\xa2\xe9\x9b\x86\xe7\x99\xbe\xe9\x9c\x80\xe4\xbb\xb7\xe8\x8a\xb1\xe5\x85\x9a\xe5\x8d\x8e\xe5\x9f\x8e\xe7\x9f\xb3\xe7\xba\xa7\xe6\x95\xb4"
+    "\xe5\xba\x9c\xe7\xa6\xbb\xe5\x86\xb5\xe4\xba\x9a\xe8\xaf\xb7\xe6\x8a\x80\xe9\x99\x85\xe7\xba\xa6\xe7\xa4\xba\xe5\xa4\x8d\xe7\x97\x85\xe6\x81\xaf\xe7\xa9\xb6\xe7\xba\xbf\xe4\xbc\xbc\xe5\xae\x98"
+    "\xe7\x81\xab\xe6\x96\xad\xe7\xb2\xbe\xe6\xbb\xa1\xe6\x94\xaf\xe8\xa7\x86\xe6\xb6\x88\xe8\xb6\x8a\xe5\x99\xa8\xe5\xae\xb9\xe7\x85\xa7\xe9\xa1\xbb\xe4\xb9\x9d\xe5\xa2\x9e\xe7\xa0\x94\xe5\x86\x99"
+    "\xe7\xa7\xb0\xe4\xbc\x81\xe5\x85\xab\xe5\x8a\x9f\xe5\x90\x97\xe5\x8c\x85\xe7\x89\x87\xe5\x8f\xb2\xe5\xa7\x94\xe4\xb9\x8e\xe6\x9f\xa5\xe8\xbd\xbb\xe6\x98\x93\xe6\x97\xa9\xe6\x9b\xbe\xe9\x99\xa4"
+    "\xe5\x86\x9c\xe6\x89\xbe\xe8\xa3\x85\xe5\xb9\xbf\xe6\x98\xbe\xe5\x90\xa7\xe9\x98\xbf\xe6\x9d\x8e\xe6\xa0\x87\xe8\xb0\x88\xe5\x90\x83\xe5\x9b\xbe\xe5\xbf\xb5\xe5\x85\xad\xe5\xbc\x95\xe5\x8e\x86"
+    "\xe9\xa6\x96\xe5\x8c\xbb\xe5\xb1\x80\xe7\xaa\x81\xe4\xb8\x93\xe8\xb4\xb9\xe5\x8f\xb7\xe5\xb0\xbd\xe5\x8f\xa6\xe5\x91\xa8\xe8\xbe\x83\xe6\xb3\xa8\xe8\xaf\xad\xe4\xbb\x85\xe8\x80\x83\xe8\x90\xbd"
+    "\xe9\x9d\x92\xe9\x9a\x8f\xe9\x80\x89\xe5\x88\x97\xe6\xad\xa6\xe7\xba\xa2\xe5\x93\x8d\xe8\x99\xbd\xe6\x8e\xa8\xe5\x8a\xbf\xe5\x8f\x82\xe5\xb8\x8c\xe5\x8f\xa4\xe4\xbc\x97\xe6\x9e\x84\xe6\x88\xbf"
+    "\xe5\x8d\x8a\xe8\x8a\x82\xe5\x9c\x9f\xe6\x8a\x95\xe6\x9f\x90\xe6\xa1\x88\xe9\xbb\x91\xe7\xbb\xb4\xe9\x9d\xa9\xe5\x88\x92\xe6\x95\x8c\xe8\x87\xb4\xe9\x99\x88\xe5\xbe\x8b\xe8\xb6\xb3\xe6\x80\x81"
+    "\xe6\x8a\xa4\xe4\xb8\x83\xe5\x85\xb4\xe6\xb4\xbe\xe5\xad\xa9\xe9\xaa\x8c\xe8\xb4\xa3\xe8\x90\xa5\xe6\x98\x9f\xe5\xa4\x9f\xe7\xab\xa0\xe9\x9f\xb3\xe8\xb7\x9f\xe5\xbf\x97\xe5\xba\x95\xe7\xab\x99"
+    "\xe4\xb8\xa5\xe5\xb7\xb4\xe4\xbe\x8b\xe9\x98\xb2\xe6\x97\x8f\xe4\xbe\x9b\xe6\x95\x88\xe7\xbb\xad\xe6\x96\xbd\xe7\x95\x99\xe8\xae\xb2\xe5\x9e\x8b\xe6\x96\x99\xe7\xbb\x88\xe7\xad\x94\xe7\xb4\xa7"
+    "\xe9\xbb\x84\xe7\xbb\x9d\xe5\xa5\x87\xe5\xaf\x9f\xe6\xaf\x8d\xe4\xba\xac\xe6\xae\xb5\xe4\xbe\x9d\xe6\x89\xb9\xe7\xbe\xa4\xe9\xa1\xb9\xe6\x95\x85\xe6\x8c\x89\xe6\xb2\xb3\xe7\xb1\xb3\xe5\x9b\xb4"
+    "\xe6\xb1\x9f\xe7\xbb\x87\xe5\xae\xb3\xe6\x96\x97\xe5\x8f\x8c\xe5\xa2\x83\xe5\xae\xa2\xe7\xba\xaa\xe9\x87\x87\xe4\xb8\xbe\xe6\x9d\x80\xe6\x94\xbb\xe7\x88\xb6\xe8\x8b\x8f\xe5\xaf\x86\xe4\xbd\x8e"
+    "\xe6\x9c\x9d\xe5\x8f\x8b\xe8\xaf\x89\xe6\xad\xa2\xe7\xbb\x86\xe6\x84\xbf\xe5\x8d\x83\xe5\x80\xbc\xe4\xbb\x8d\xe7\x94\xb7\xe9\x92\xb1\xe7\xa0\xb4\xe7\xbd\x91\xe7\x83\xad\xe5\x8a\xa9\xe5\x80\x92"
+    "\xe8\x82\xb2\xe5\xb1\x9e\xe5\x9d\x90\xe5\xb8\x9d\xe9\x99\x90\xe8\x88\xb9\xe8\x84\xb8\xe8\x81\x8c\xe9\x80\x9f\xe5\x88\xbb\xe4\xb9\x90\xe5\x90\xa6\xe5\x88\x9a\xe5\xa8\x81\xe6\xaf\x9b\xe7\x8a\xb6"
+    "\xe7\x8e\x87\xe7\x94\x9a\xe7\x8b\xac\xe7\x90\x83\xe8\x88\xac\xe6\x99\xae\xe6\x80\x95\xe5\xbc\xb9\xe6\xa0\xa1\xe8\x8b\xa6\xe5\x88\x9b\xe5\x81\x87\xe4\xb9\x85\xe9\x94\x99\xe6\x89\xbf\xe5\x8d\xb0"
+    "\xe6\x99\x9a\xe5\x85\xb0\xe8\xaf\x95\xe8\x82\xa1\xe6\x8b\xbf\xe8\x84\x91\xe9\xa2\x84\xe8\xb0\x81\xe7\x9b\x8a\xe9\x98\xb3\xe8\x8b\xa5\xe5\x93\xaa\xe5\xbe\xae\xe5\xb0\xbc\xe7\xbb\xa7\xe9\x80\x81"
+    "\xe6\x80\xa5\xe8\xa1\x80\xe6\x83\x8a\xe4\xbc\xa4\xe7\xb4\xa0\xe8\x8d\xaf\xe9\x80\x82\xe6\xb3\xa2\xe5\xa4\x9c\xe7\x9c\x81\xe5\x88\x9d\xe5\x96\x9c\xe5\x8d\xab\xe6\xba\x90\xe9\xa3\x9f\xe9\x99\xa9"
+    "\xe5\xbe\x85\xe8\xbf\xb0\xe9\x99\x86\xe4\xb9\xa0\xe7\xbd\xae\xe5\xb1\x85\xe5\x8a\xb3\xe8\xb4\xa2\xe7\x8e\xaf\xe6\x8e\x92\xe7\xa6\x8f\xe7\xba\xb3\xe6\xac\xa2\xe9\x9b\xb7\xe8\xad\xa6\xe8\x8e\xb7"
+    "\xe6\xa8\xa1\xe5\x85\x85\xe8\xb4\x9f\xe4\xba\x91\xe5\x81\x9c\xe6\x9c\xa8\xe6\xb8\xb8\xe9\xbe\x99\xe6\xa0\x91\xe7\x96\x91\xe5\xb1\x82\xe5\x86\xb7\xe6\xb4\xb2\xe5\x86\xb2\xe5\xb0\x84\xe7\x95\xa5"
+    "\xe8\x8c\x83\xe7\xab\x9f\xe5\x8f\xa5\xe5\xae\xa4\xe5\xbc\x82\xe6\xbf\x80\xe6\xb1\x89\xe6\x9d\x91\xe5\x93\x88\xe7\xad\x96\xe6\xbc\x94\xe7\xae\x80\xe5\x8d\xa1\xe7\xbd\xaa\xe5\x88\xa4\xe6\x8b\x85"
+    "\xe5\xb7\x9e\xe9\x9d\x99\xe9\x80\x80\xe6\x97\xa2\xe8\xa1\xa3\xe6\x82\xa8\xe5\xae\x97\xe7\xa7\xaf\xe4\xbd\x99\xe7\x97\x9b\xe6\xa3\x80\xe5\xb7\xae\xe5\xaf\x8c\xe7\x81\xb5\xe5\x8d\x8f\xe8\xa7\x92"
+    "\xe5\x8d\xa0\xe9\x85\x8d\xe5\xbe\x81\xe4\xbf\xae\xe7\x9a\xae\xe6\x8c\xa5\xe8\x83\x9c\xe9\x99\x8d\xe9\x98\xb6\xe5\xae\xa1\xe6\xb2\x89\xe5\x9d\x9a\xe5\x96\x84\xe5\xa6\x88\xe5\x88\x98\xe8\xaf\xbb"
+    "\xe5\x95\x8a\xe8\xb6\x85\xe5\x85\x8d\xe5\x8e\x8b\xe9\x93\xb6\xe4\xb9\xb0\xe7\x9a\x87\xe5\x85\xbb\xe4\xbc\x8a\xe6\x80\x80\xe6\x89\xa7\xe5\x89\xaf\xe4\xb9\xb1\xe6\x8a\x97\xe7\x8a\xaf\xe8\xbf\xbd"
+    "\xe5\xb8\xae\xe5\xae\xa3\xe4\xbd\x9b\xe5\xb2\x81\xe8\x88\xaa\xe4\xbc\x98\xe6\x80\xaa\xe9\xa6\x99\xe8\x91\x97\xe7\x94\xb0\xe9\x93\x81\xe6\x8e\xa7\xe7\xa8\x8e\xe5\xb7\xa6\xe5\x8f\xb3\xe4\xbb\xbd"
+    "\xe7\xa9\xbf\xe8\x89\xba\xe8\x83\x8c\xe9\x98\xb5\xe8\x8d\x89\xe8\x84\x9a\xe6\xa6\x82\xe6\x81\xb6\xe5\x9d\x97\xe9\xa1\xbf\xe6\x95\xa2\xe5\xae\x88\xe9\x85\x92\xe5\xb2\x9b\xe6\x89\x98\xe5\xa4\xae"
+    "\xe6\x88\xb7\xe7\x83\x88\xe6\xb4\x8b\xe5\x93\xa5\xe7\xb4\xa2\xe8\x83\xa1\xe6\xac\xbe\xe9\x9d\xa0\xe8\xaf\x84\xe7\x89\x88\xe5\xae\x9d\xe5\xba\xa7\xe9\x87\x8a\xe6\x99\xaf\xe9\xa1\xbe\xe5\xbc\x9f"
+    "\xe7\x99\xbb\xe8\xb4\xa7\xe4\xba\x92\xe4\xbb\x98\xe4\xbc\xaf\xe6\x85\xa2\xe6\xac\xa7\xe6\x8d\xa2\xe9\x97\xbb\xe5\x8d\xb1\xe5\xbf\x99\xe6\xa0\xb8\xe6\x9a\x97\xe5\xa7\x90\xe4\xbb\x8b\xe5\x9d\x8f"
+    "\xe8\xae\xa8\xe4\xb8\xbd\xe8\x89\xaf\xe5\xba\x8f\xe5\x8d\x87\xe7\x9b\x91\xe4\xb8\xb4\xe4\xba\xae\xe9\x9c\xb2\xe6\xb0\xb8\xe5\x91\xbc\xe5\x91\xb3\xe9\x87\x8e\xe6\x9e\xb6\xe5\x9f\x9f\xe6\xb2\x99"
+    "\xe6\x8e\x89\xe6\x8b\xac\xe8\x88\xb0\xe9\xb1\xbc\xe6\x9d\x82\xe8\xaf\xaf\xe6\xb9\xbe\xe5\x90\x89\xe5\x87\x8f\xe7\xbc\x96\xe6\xa5\x9a\xe8\x82\xaf\xe6\xb5\x8b\xe8\xb4\xa5\xe5\xb1\x8b\xe8\xb7\x91"
+    "\xe6\xa2\xa6\xe6\x95\xa3\xe6\xb8\xa9\xe5\x9b\xb0\xe5\x89\x91\xe6\xb8\x90\xe5\xb0\x81\xe6\x95\x91\xe8\xb4\xb5\xe6\x9e\xaa\xe7\xbc\xba\xe6\xa5\xbc\xe5\x8e\xbf\xe5\xb0\x9a\xe6\xaf\xab\xe7\xa7\xbb"
+    "\xe5\xa8\x98\xe6\x9c\x8b\xe7\x94\xbb\xe7\x8f\xad\xe6\x99\xba\xe4\xba\xa6\xe8\x80\xb3\xe6\x81\xa9\xe7\x9f\xad\xe6\x8e\x8c\xe6\x81\x90\xe9\x81\x97\xe5\x9b\xba\xe5\xb8\xad\xe6\x9d\xbe\xe7\xa7\x98"
+    "\xe8\xb0\xa2\xe9\xb2\x81\xe9\x81\x87\xe5\xba\xb7\xe8\x99\x91\xe5\xb9\xb8\xe5\x9d\x87\xe9\x94\x80\xe9\x92\x9f\xe8\xaf\x97\xe8\x97\x8f\xe8\xb5\xb6\xe5\x89\xa7\xe7\xa5\xa8\xe6\x8d\x9f\xe5\xbf\xbd"
+    "\xe5\xb7\xa8\xe7\x82\xae\xe6\x97\xa7\xe7\xab\xaf\xe6\x8e\xa2\xe6\xb9\x96\xe5\xbd\x95\xe5\x8f\xb6\xe6\x98\xa5\xe4\xb9\xa1\xe9\x99\x84\xe5\x90\xb8\xe4\xba\x88\xe7\xa4\xbc\xe6\xb8\xaf\xe9\x9b\xa8"
+    "\xe5\x91\x80\xe6\x9d\xbf\xe5\xba\xad\xe5\xa6\x87\xe5\xbd\x92\xe7\x9d\x9b\xe9\xa5\xad\xe9\xa2\x9d\xe5\x90\xab\xe9\xa1\xba\xe8\xbe\x93\xe6\x91\x87\xe6\x8b\x9b\xe5\xa9\x9a\xe8\x84\xb1\xe8\xa1\xa5"
+    "\xe8\xb0\x93\xe7\x9d\xa3\xe6\xaf\x92\xe6\xb2\xb9\xe7\x96\x97\xe6\x97\x85\xe6\xb3\xbd\xe6\x9d\x90\xe7\x81\xad\xe9\x80\x90\xe8\x8e\xab\xe7\xac\x94\xe4\xba\xa1\xe9\xb2\x9c\xe8\xaf\x8d\xe5\x9c\xa3"
+    "\xe6\x8b\xa9\xe5\xaf\xbb\xe5\x8e\x82\xe7\x9d\xa1\xe5\x8d\x9a\xe5\x8b\x92\xe7\x83\x9f\xe6\x8e\x88\xe8\xaf\xba\xe4\xbc\xa6\xe5\xb2\xb8\xe5\xa5\xa5\xe5\x94\x90\xe5\x8d\x96\xe4\xbf\x84\xe7\x82\xb8"
+    "\xe8\xbd\xbd\xe6\xb4\x9b\xe5\x81\xa5\xe5\xa0\x82\xe6\x97\x81\xe5\xae\xab\xe5\x96\x9d\xe5\x80\x9f\xe5\x90\x9b\xe7\xa6\x81\xe9\x98\xb4\xe5\x9b\xad\xe8\xb0\x8b\xe5\xae\x8b\xe9\x81\xbf\xe6\x8a\x93"
+    "\xe8\x8d\xa3\xe5\xa7\x91\xe5\xad\x99\xe9\x80\x83\xe7\x89\x99\xe6\x9d\x9f\xe8\xb7\xb3\xe9\xa1\xb6\xe7\x8e\x89\xe9\x95\x87\xe9\x9b\xaa\xe5\x8d\x88\xe7\xbb\x83\xe8\xbf\xab\xe7\x88\xb7\xe7\xaf\x87"
+    "\xe8\x82\x89\xe5\x98\xb4\xe9\xa6\x86\xe9\x81\x8d\xe5\x87\xa1\xe7\xa1\x80\xe6\xb4\x9e\xe5\x8d\xb7\xe5\x9d\xa6\xe7\x89\x9b\xe5\xae\x81\xe7\xba\xb8\xe8\xaf\xb8\xe8\xae\xad\xe7\xa7\x81\xe5\xba\x84"
+    "\xe7\xa5\x96\xe4\xb8\x9d\xe7\xbf\xbb\xe6\x9a\xb4\xe6\xa3\xae\xe5\xa1\x94\xe9\xbb\x98\xe6\x8f\xa1\xe6\x88\x8f\xe9\x9a\x90\xe7\x86\x9f\xe9\xaa\xa8\xe8\xae\xbf\xe5\xbc\xb1\xe8\x92\x99\xe6\xad\x8c"
+    "\xe5\xba\x97\xe9\xac\xbc\xe8\xbd\xaf\xe5\x85\xb8\xe6\xac\xb2\xe8\x90\xa8\xe4\xbc\x99\xe9\x81\xad\xe7\x9b\x98\xe7\x88\xb8\xe6\x89\xa9\xe7\x9b\x96\xe5\xbc\x84\xe9\x9b\x84\xe7\xa8\xb3\xe5\xbf\x98"
+    "\xe4\xba\xbf\xe5\x88\xba\xe6\x8b\xa5\xe5\xbe\x92\xe5\xa7\x86\xe6\x9d\xa8\xe9\xbd\x90\xe8\xb5\x9b\xe8\xb6\xa3\xe6\x9b\xb2\xe5\x88\x80\xe5\xba\x8a\xe8\xbf\x8e\xe5\x86\xb0\xe8\x99\x9a\xe7\x8e\xa9"
+    "\xe6\x9e\x90\xe7\xaa\x97\xe9\x86\x92\xe5\xa6\xbb\xe9\x80\x8f\xe8\xb4\xad\xe6\x9b\xbf\xe5\xa1\x9e\xe5\x8a\xaa\xe4\xbc\x91\xe8\x99\x8e\xe6\x89\xac\xe9\x80\x94\xe4\xbe\xb5\xe5\x88\x91\xe7\xbb\xbf"
+    "\xe5\x85\x84\xe8\xbf\x85\xe5\xa5\x97\xe8\xb4\xb8\xe6\xaf\x95\xe5\x94\xaf\xe8\xb0\xb7\xe8\xbd\xae\xe5\xba\x93\xe8\xbf\xb9\xe5\xb0\xa4\xe7\xab\x9e\xe8\xa1\x97\xe4\xbf\x83\xe5\xbb\xb6\xe9\x9c\x87"
+    "\xe5\xbc\x83\xe7\x94\xb2\xe4\xbc\x9f\xe9\xba\xbb\xe5\xb7\x9d\xe7\x94\xb3\xe7\xbc\x93\xe6\xbd\x9c\xe9\x97\xaa\xe5\x94\xae\xe7\x81\xaf\xe9\x92\x88\xe5\x93\xb2\xe7\xbb\x9c\xe6\x8a\xb5\xe6\x9c\xb1"
+    "\xe5\x9f\x83\xe6\x8a\xb1\xe9\xbc\x93\xe6\xa4\x8d\xe7\xba\xaf\xe5\xa4\x8f\xe5\xbf\x8d\xe9\xa1\xb5\xe6\x9d\xb0\xe7\xad\x91\xe6\x8a\x98\xe9\x83\x91\xe8\xb4\x9d\xe5\xb0\x8a\xe5\x90\xb4\xe7\xa7\x80"
+    "\xe6\xb7\xb7\xe8\x87\xa3\xe9\x9b\x85\xe6\x8c\xaf\xe6\x9f\x93\xe7\x9b\x9b\xe6\x80\x92\xe8\x88\x9e\xe5\x9c\x86\xe6\x90\x9e\xe7\x8b\x82\xe6\x8e\xaa\xe5\xa7\x93\xe6\xae\x8b\xe7\xa7\x8b\xe5\x9f\xb9"
+    "\xe8\xbf\xb7\xe8\xaf\x9a\xe5\xae\xbd\xe5\xae\x87\xe7\x8c\x9b\xe6\x91\x86\xe6\xa2\x85\xe6\xaf\x81\xe4\xbc\xb8\xe6\x91\xa9\xe7\x9b\x9f\xe6\x9c\xab\xe4\xb9\x83\xe6\x82\xb2\xe6\x8b\x8d\xe4\xb8\x81"
+    "\xe8\xb5\xb5\xe4\xbe\xa7\xe6\x97\x97\xe5\xae\x9c\xe4\xbd\xb3\xe4\xbb\xaa\xe5\x95\xa6\xe5\x93\xa6\xe5\x97\xaf\xe5\x91\xb5\xe5\x98\xbf\xe5\x93\x87\xe5\x96\xb5\xe8\xb5\x9e\xe9\x80\xbc\xe6\x92\xad"
+    "\xe5\xb9\x95";
+
+}
@@ -24,19 +24,29 @@
 
 namespace dmhm {
 
-DanmakuEntry::DanmakuEntry(const std::string &message) :
+DanmakuEntry::DanmakuEntry(const std::string &message, std::chrono::steady_clock::time_point timestamp) :
     message(std::move(message)),
-    timestamp(std::chrono::steady_clock::now()) {
+    timestamp(timestamp) {
 }
 
 DanmakuEntry::DanmakuEntry(const DanmakuEntry &other) :
     message(other.message),
-    timestamp(other.timestamp) {
+    timestamp(other.timestamp),
+    sender(other.sender),
+    has_color(other.has_color),
+    color(other.color),
+    priority(other.priority),
+    source_time(other.source_time) {
 }
 
 DanmakuEntry::DanmakuEntry(DanmakuEntry &&other) {
     std::swap(message, other.message);
     std::swap(timestamp, other.timestamp);
+    std::swap(sender, other.sender);
+    std::swap(has_color, other.has_color);
+    std::swap(color, other.color);
+    std::swap(priority, other.priority);
+    std::swap(source_time, other.source_time);
 }
 
 }
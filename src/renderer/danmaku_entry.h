@@ -21,18 +21,26 @@
 
 #include "../utils.h"
 #include <chrono>
+#include <cstdint>
 #include <string>
 
 namespace dmhm {
 
 struct DanmakuEntry {
 
-    DanmakuEntry(const std::string &message);
+    DanmakuEntry(const std::string &message, std::chrono::steady_clock::time_point timestamp);
     DanmakuEntry(const DanmakuEntry &other);
     DanmakuEntry(DanmakuEntry &&other);
 
+    /* The text shown, after the tag of its source and the sender */
     std::string message;
     std::chrono::steady_clock::time_point timestamp;
+    /* Only from structured input, input_format = "json" or "binary" */
+    std::string sender;
+    bool has_color = false;
+    uint32_t color = 0; // 0xRRGGBB
+    int32_t priority = 0;
+    double source_time = 0; // Seconds since the Unix epoch when the source sent it, 0 if unknown
 
 };
 
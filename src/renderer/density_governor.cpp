@@ -0,0 +1,154 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "density_governor.h"
+#include "../utils.h"
+#include "../config.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace dmhm {
+
+/* The chat rate is averaged over about this many seconds */
+static const double rate_time_constant = 10;
+
+struct DensityGovernorPrivate {
+    double stage_height = 0;
+    double mean_line_height = 0;
+    double capacity = 1; // Lines that fit on the stage
+
+    /* Exponentially decaying count of arrivals, divided by the time constant */
+    double rate = 0;
+    std::chrono::steady_clock::time_point rate_checkpoint;
+    bool has_arrivals = false;
+
+    /* Token bucket for admission */
+    double tokens = 0;
+    std::chrono::steady_clock::time_point token_checkpoint;
+
+    std::chrono::steady_clock::time_point stats_checkpoint;
+    uint32_t arrived = 0;
+    uint32_t dropped = 0;
+    uint32_t shortened = 0;
+    uint32_t expired = 0;
+    uint32_t scrolled_out = 0;
+    uint32_t evicted = 0;
+
+    static double seconds(std::chrono::steady_clock::duration duration);
+    void update_rate(std::chrono::steady_clock::time_point timestamp);
+};
+
+DensityGovernor::DensityGovernor() {
+}
+
+DensityGovernor::~DensityGovernor() {
+}
+
+void DensityGovernor::set_stage_height(double height) {
+    p->stage_height = height;
+    if(p->mean_line_height > 0)
+        p->capacity = std::max(height/p->mean_line_height, 1.0);
+}
+
+bool DensityGovernor::admit(std::chrono::steady_clock::time_point timestamp, double line_height) {
+    p->arrived++;
+    if(p->mean_line_height == 0)
+        p->mean_line_height = line_height;
+    else
+        p->mean_line_height += (line_height-p->mean_line_height)/16;
+    set_stage_height(p->stage_height);
+
+    p->update_rate(timestamp);
+    p->rate += 1/rate_time_constant;
+    if(!config::adaptive_lifetime)
+        return true;
+
+    /* A full stage worth of lines may arrive at once, then no faster than they can leave */
+    double burst = p->capacity;
+    if(!p->has_arrivals)
+        p->tokens = burst;
+    else
+        p->tokens = std::min(p->tokens + p->seconds(timestamp-p->token_checkpoint)*p->capacity/config::danmaku_min_lifetime, burst);
+    p->token_checkpoint = timestamp;
+    p->has_arrivals = true;
+    if(p->tokens < 1) {
+        p->dropped++;
+        return false;
+    }
+    p->tokens -= 1;
+    if(get_lifetime() < config::danmaku_lifetime)
+        p->shortened++;
+    return true;
+}
+
+double DensityGovernor::get_lifetime() const {
+    if(!config::adaptive_lifetime || p->rate <= 0)
+        return config::danmaku_lifetime;
+    return std::min(std::max(p->capacity/p->rate, config::danmaku_min_lifetime), config::danmaku_lifetime);
+}
+
+size_t DensityGovernor::get_max_lines() const {
+    if(config::max_danmaku_lines != 0)
+        return config::max_danmaku_lines;
+    /* Lines scrolling out of the top are still visible for a moment */
+    return size_t(std::ceil(p->capacity*2));
+}
+
+void DensityGovernor::count_expired(uint32_t count) {
+    p->expired += count;
+}
+
+void DensityGovernor::count_scrolled_out(uint32_t count) {
+    p->scrolled_out += count;
+}
+
+void DensityGovernor::count_evicted(uint32_t count) {
+    p->evicted += count;
+}
+
+void DensityGovernor::print_stats(std::chrono::steady_clock::time_point now, size_t live_lines) {
+    /* Counting starts with the first frame, in the time of the renderer's clock */
+    if(p->stats_checkpoint == std::chrono::steady_clock::time_point())
+        p->stats_checkpoint = now;
+    if(now-p->stats_checkpoint < std::chrono::seconds(10))
+        return;
+    if(p->dropped != 0 || p->shortened != 0 || p->evicted != 0) {
+        p->update_rate(now);
+        std::cerr << "Density: " << p->rate << " lines/s, lifetime " << get_lifetime() << " s, " << live_lines << " live of " << p->capacity << " on stage; "
+            << p->arrived << " arrived, " << p->dropped << " dropped, " << p->shortened << " shortened, "
+            << p->expired << " expired, " << p->scrolled_out << " scrolled out, " << p->evicted << " evicted" << std::endl;
+    }
+    p->arrived = p->dropped = p->shortened = 0;
+    p->expired = p->scrolled_out = p->evicted = 0;
+    p->stats_checkpoint = now;
+}
+
+double DensityGovernorPrivate::seconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+void DensityGovernorPrivate::update_rate(std::chrono::steady_clock::time_point timestamp) {
+    if(timestamp > rate_checkpoint) {
+        rate *= std::exp(-seconds(timestamp-rate_checkpoint)/rate_time_constant);
+        rate_checkpoint = timestamp;
+    }
+}
+
+}
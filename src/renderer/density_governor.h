@@ -0,0 +1,58 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#pragma once
+
+#include "../utils.h"
+#include <chrono>
+#include <cstdint>
+
+namespace dmhm {
+
+/* Keeps the number of live lines near what the stage can show.
+   By Little's law the stage holds about chat rate * lifetime lines, so new
+   lines get a lifetime of capacity / rate, between danmaku_min_lifetime and
+   danmaku_lifetime. When even the shortest lifetime is not enough, lines
+   are admitted no faster than capacity / danmaku_min_lifetime, and the
+   oldest lines are evicted above max_danmaku_lines. */
+class DensityGovernor {
+
+public:
+
+    DensityGovernor();
+    ~DensityGovernor();
+    /* Call once per frame before admitting */
+    void set_stage_height(double height);
+    /* Counts an arriving line, returns false when it should be dropped */
+    bool admit(std::chrono::steady_clock::time_point timestamp, double line_height);
+    /* In seconds, for lines admitted now */
+    double get_lifetime() const;
+    size_t get_max_lines() const;
+    void count_expired(uint32_t count);
+    void count_scrolled_out(uint32_t count);
+    void count_evicted(uint32_t count);
+    /* Prints counters every ten seconds if lines were cut short */
+    void print_stats(std::chrono::steady_clock::time_point now, size_t live_lines);
+
+private:
+
+    proxy_ptr<struct DensityGovernorPrivate> p;
+
+};
+
+}
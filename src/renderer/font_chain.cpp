@@ -0,0 +1,214 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "font_chain.h"
+#include "../utils.h"
+#include "../config.h"
+#include "../mapped_file.h"
+#include "glyph_cache.h"
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "freetype_includer.h"
+
+namespace dmhm {
+
+/* Two-level bitset over the Unicode codespace,
+   only 256-codepoint pages with coverage are allocated */
+class CodepointSet {
+public:
+    CodepointSet() :
+        pages(page_count) {
+    }
+    bool contains(uint32_t codepoint) const {
+        uint32_t page = codepoint >> 8;
+        if(page >= page_count || !pages[page])
+            return false;
+        return (pages[page][(codepoint >> 6) & 3] >> (codepoint & 63)) & 1;
+    }
+    void insert(uint32_t codepoint) {
+        uint32_t page = codepoint >> 8;
+        if(page >= page_count)
+            return;
+        if(!pages[page])
+            pages[page].reset(new uint64_t[4]());
+        pages[page][(codepoint >> 6) & 3] |= uint64_t(1) << (codepoint & 63);
+    }
+private:
+    static const uint32_t page_count = 0x110000 >> 8;
+    std::vector<std::unique_ptr<uint64_t[]>> pages;
+};
+
+struct FontChainFace {
+    std::string font_file;
+    uint32_t font_file_index = 0;
+    bool loaded = false;
+    MappedFile mapping;
+    FT_Face ft_face = nullptr;
+    std::unique_ptr<GlyphCache> glyph_cache;
+    CodepointSet coverage;
+};
+
+struct FontChainPrivate {
+    FT_Library freetype = nullptr;
+    std::vector<std::unique_ptr<FontChainFace>> faces;
+    /* Index of face plus one for each resolved codepoint, 0 if unresolved */
+    std::vector<std::unique_ptr<uint8_t[]>> resolved_pages;
+
+    FT_Error load_face(size_t index);
+    size_t resolve(uint32_t codepoint);
+};
+
+FontChain::FontChain() {
+    p->resolved_pages.resize(0x110000 >> 8);
+}
+
+FontChain::~FontChain() {
+    for(std::unique_ptr<FontChainFace> &face : p->faces) {
+        /* Stops the prewarm thread and flushes the cache file */
+        face->glyph_cache.reset();
+        if(face->ft_face) {
+            FT_Done_Face(face->ft_face);
+            face->ft_face = nullptr;
+        }
+    }
+    if(p->freetype) {
+        FT_Done_FreeType(p->freetype);
+        p->freetype = nullptr;
+    }
+}
+
+FT_Error FontChain::open_primary(const char *font_file, uint32_t font_file_index) {
+    dmhm_assert(p->faces.empty());
+    FT_Error ft_error = FT_Init_FreeType(&p->freetype);
+    if(ft_error != 0)
+        return ft_error;
+    p->faces.emplace_back(new FontChainFace);
+    p->faces[0]->font_file = font_file;
+    p->faces[0]->font_file_index = font_file_index;
+    return p->load_face(0);
+}
+
+/* font_spec is a file name, optionally followed by #index for TTC files */
+void FontChain::add_fallback(const std::string &font_spec) {
+    dmhm_assert(!p->faces.empty());
+    /* resolved_pages stores the index in a byte */
+    if(p->faces.size() >= 255) {
+        std::cerr << "Too many fallback fonts, ignoring " << font_spec << std::endl;
+        return;
+    }
+    std::unique_ptr<FontChainFace> face(new FontChainFace);
+    face->font_file = font_spec;
+    size_t hash_pos = font_spec.rfind('#');
+    if(hash_pos != std::string::npos && hash_pos+1 < font_spec.size() && font_spec.find_first_not_of("0123456789", hash_pos+1) == std::string::npos) {
+        face->font_file = font_spec.substr(0, hash_pos);
+        face->font_file_index = uint32_t(std::strtoul(font_spec.c_str()+hash_pos+1, nullptr, 10));
+    }
+    p->faces.push_back(std::move(face));
+}
+
+const Glyph *FontChain::get_glyph(uint32_t codepoint) {
+    return p->faces[p->resolve(codepoint)]->glyph_cache->get_glyph(codepoint);
+}
+
+void FontChain::layout_text(const std::string &text, GlyphRun &run) {
+    std::u32string ucs4text = utf8_to_ucs4(text);
+    bool has_ink = false;
+    int32_t pen_x = 0;
+    run.items.clear();
+    run.items.reserve(ucs4text.size());
+    run.ink_top = 0;
+    run.ink_bottom = 0;
+    for(char32_t codepoint : ucs4text) {
+        const Glyph *glyph = get_glyph(uint32_t(codepoint));
+        run.items.push_back({glyph, pen_x});
+        if(glyph->width != 0 && glyph->height != 0) {
+            if(!has_ink) {
+                run.ink_top = glyph->top;
+                run.ink_bottom = int32_t(glyph->height)-glyph->top;
+                has_ink = true;
+            } else {
+                run.ink_top = std::max(run.ink_top, glyph->top);
+                run.ink_bottom = std::max(run.ink_bottom, int32_t(glyph->height)-glyph->top);
+            }
+        }
+        pen_x += glyph->advance;
+    }
+    run.advance = pen_x;
+}
+
+FT_Error FontChainPrivate::load_face(size_t index) {
+    FontChainFace &face = *faces[index];
+    face.loaded = true;
+    if(!face.mapping.open(face.font_file.c_str()))
+        return FT_Err_Cannot_Open_Resource;
+    FT_Error ft_error = FT_New_Memory_Face(freetype, face.mapping.data(), FT_Long(face.mapping.size()), FT_Long(face.font_file_index), &face.ft_face);
+    if(ft_error != 0) {
+        face.ft_face = nullptr;
+        return ft_error;
+    }
+    ft_error = set_face_size(face.ft_face, config::font_size);
+    if(ft_error != 0)
+        return ft_error;
+
+    FT_UInt glyph_index;
+    FT_ULong codepoint = FT_Get_First_Char(face.ft_face, &glyph_index);
+    while(glyph_index != 0) {
+        face.coverage.insert(uint32_t(codepoint));
+        codepoint = FT_Get_Next_Char(face.ft_face, codepoint, &glyph_index);
+    }
+
+    /* Each face gets its own cache file, only the primary face is prewarmed */
+    std::string cache_file = config::glyph_cache_file;
+    if(!cache_file.empty() && index != 0)
+        cache_file += "."+std::to_string(index);
+    face.glyph_cache.reset(new GlyphCache(face.ft_face, face.mapping.data(), face.mapping.size(), face.font_file_index, config::font_size, cache_file.c_str(), index == 0 ? config::glyph_cache_charset : nullptr));
+    return 0;
+}
+
+size_t FontChainPrivate::resolve(uint32_t codepoint) {
+    uint32_t page = codepoint >> 8;
+    if(page >= resolved_pages.size())
+        return 0;
+    if(!resolved_pages[page])
+        resolved_pages[page].reset(new uint8_t[256]());
+    uint8_t &resolved = resolved_pages[page][codepoint & 0xff];
+    if(resolved != 0)
+        return resolved-1;
+
+    /* Tofu from the primary face if nothing covers it */
+    resolved = 1;
+    for(size_t i = 0; i < faces.size(); i++) {
+        if(!faces[i]->loaded) {
+            FT_Error ft_error = load_face(i);
+            if(ft_error != 0)
+                std::cerr << "Failed to load fallback font " << faces[i]->font_file << " (FreeType error " << ft_error << ")" << std::endl;
+        }
+        if(faces[i]->glyph_cache && faces[i]->coverage.contains(codepoint)) {
+            resolved = uint8_t(i+1);
+            break;
+        }
+    }
+    return resolved-1;
+}
+
+}
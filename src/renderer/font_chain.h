@@ -0,0 +1,52 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include "glyph_cache.h"
+#include "freetype_includer.h"
+#include <cstdint>
+#include <string>
+
+namespace dmhm {
+
+/* The configured font followed by fallback fonts, tried in order.
+   Fallback faces are opened the first time a codepoint is not covered
+   by any face before them; a coverage bitset per face and a lazily
+   filled codepoint-to-face table keep resolution O(1).
+   Not thread-safe, use from one thread at a time, such as the prerasterizer's. */
+class FontChain {
+
+public:
+
+    FontChain();
+    ~FontChain();
+    FT_Error open_primary(const char *font_file, uint32_t font_file_index);
+    void add_fallback(const std::string &font_spec);
+    const Glyph *get_glyph(uint32_t codepoint);
+    void layout_text(const std::string &text, GlyphRun &run);
+
+private:
+
+    proxy_ptr<struct FontChainPrivate> p;
+
+};
+
+}
@@ -0,0 +1,227 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "frame_ring.h"
+#include "frame_ring_format.h"
+#include "../utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <string>
+#ifdef __linux__
+#include <fcntl.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dmhm {
+
+struct FrameRingPrivate {
+    std::string name;
+    uint32_t slot_count;
+    uint8_t *mapping = nullptr;
+    size_t mapping_size = 0;
+    dmhm_frame_ring_header *header = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t last_band_top = 0;
+    uint64_t sequence = 0;
+    bool failed = false;
+    bool create(uint32_t width, uint32_t height);
+    void release();
+    dmhm_frame_slot *get_slot(uint64_t sequence) const;
+};
+
+static inline uint64_t to_nanoseconds(std::chrono::steady_clock::time_point time) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+FrameRing::FrameRing(const char *name, uint32_t slot_count) {
+    dmhm_assert(name[0] == '/');
+    dmhm_assert(slot_count >= 2);
+    p->name = name;
+    p->slot_count = slot_count;
+}
+
+FrameRing::~FrameRing() {
+    p->release();
+}
+
+#ifdef __linux__
+
+void FrameRing::publish(const uint32_t *bitmap, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top, bool repeated, std::chrono::steady_clock::time_point render_time) {
+    if(p->failed)
+        return;
+    if((width != p->width || height != p->height) && !p->create(width, height))
+        return;
+
+    uint64_t sequence = ++p->sequence;
+    dmhm_frame_slot *slot = p->get_slot(sequence);
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    uint8_t *pixels = reinterpret_cast<uint8_t *>(slot) + DMHM_FRAME_SLOT_HEADER_SIZE;
+    size_t row_size = size_t(width)*sizeof (uint32_t);
+    /* The slot still holds a frame from slot_count frames ago, clear whatever it had above the band */
+    for(uint32_t row = std::min(slot->band_top, band_top); row < band_top; row++)
+        std::memset(pixels + size_t(row)*p->header->stride, 0, row_size);
+    for(uint32_t row = band_top; row < height; row++)
+        std::memcpy(pixels + size_t(row)*p->header->stride, bitmap + size_t(row)*stride, row_size);
+    slot->render_ns = to_nanoseconds(render_time);
+    slot->publish_ns = to_nanoseconds(std::chrono::steady_clock::now());
+    /* Every row inside either band has moved or changed */
+    uint32_t dirty_top = repeated ? height : std::min(p->last_band_top, band_top);
+    slot->dirty_x = 0;
+    slot->dirty_y = dirty_top;
+    slot->dirty_width = dirty_top < height ? width : 0;
+    slot->dirty_height = height - dirty_top;
+    slot->band_top = band_top;
+    p->last_band_top = band_top;
+    __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&p->header->latest_sequence, sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&p->header->latest, uint32_t(sequence), __ATOMIC_SEQ_CST);
+    /* No system call unless someone sleeps on it */
+    if(__atomic_load_n(&p->header->waiters, __ATOMIC_SEQ_CST) != 0)
+        syscall(SYS_futex, &p->header->latest, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/* Whether a ring by this name has a writer that is still running */
+static bool is_ring_in_use(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if(fd == -1)
+        return false;
+    struct stat file_stat;
+    void *data = MAP_FAILED;
+    if(fstat(fd, &file_stat) == 0 && size_t(file_stat.st_size) >= sizeof (dmhm_frame_ring_header))
+        data = mmap(nullptr, sizeof (dmhm_frame_ring_header), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+        return false;
+    const dmhm_frame_ring_header *header = reinterpret_cast<const dmhm_frame_ring_header *>(data);
+    bool in_use = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == DMHM_FRAME_RING_MAGIC &&
+        __atomic_load_n(&header->writer_alive, __ATOMIC_SEQ_CST) != 0 &&
+        header->writer_pid != 0 && (kill(pid_t(header->writer_pid), 0) == 0 || errno == EPERM);
+    munmap(data, sizeof (dmhm_frame_ring_header));
+    return in_use;
+}
+
+bool FrameRingPrivate::create(uint32_t width, uint32_t height) {
+    release();
+    uint32_t stride = (width*sizeof (uint32_t) + 63) & ~uint32_t(63);
+    uint64_t slot_size = DMHM_FRAME_SLOT_HEADER_SIZE + uint64_t(stride)*height;
+    uint32_t slot_offset = (sizeof (dmhm_frame_ring_header) + 63) & ~uint32_t(63);
+    size_t size = slot_offset + slot_size*slot_count;
+
+    /* A stale ring from a crashed run is replaced, a ring another instance is writing is not */
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd == -1 && errno == EEXIST) {
+        if(is_ring_in_use(name.c_str())) {
+            std::cerr << "Frame ring " << name << " is in use by another running instance, not publishing frames" << std::endl;
+            failed = true;
+            return false;
+        }
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if(fd == -1) {
+        std::cerr << "Failed to create frame ring " << name << ": " << std::strerror(errno) << std::endl;
+        failed = true;
+        return false;
+    }
+    void *data = MAP_FAILED;
+    if(ftruncate(fd, off_t(size)) == 0)
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd);
+    if(data == MAP_FAILED) {
+        std::cerr << "Failed to map frame ring " << name << ": " << std::strerror(error) << std::endl;
+        shm_unlink(name.c_str());
+        failed = true;
+        return false;
+    }
+
+    /* Zero filled by ftruncate, so every slot starts transparent */
+    mapping = reinterpret_cast<uint8_t *>(data);
+    mapping_size = size;
+    header = reinterpret_cast<dmhm_frame_ring_header *>(mapping);
+    header->version = DMHM_FRAME_RING_VERSION;
+    header->slot_count = slot_count;
+    header->width = width;
+    header->height = height;
+    header->stride = stride;
+    header->slot_offset = slot_offset;
+    header->slot_size = slot_size;
+    header->writer_alive = 1;
+    header->writer_pid = uint32_t(getpid());
+    for(uint32_t i = 0; i < slot_count; i++)
+        get_slot(i)->band_top = height;
+    __atomic_store_n(&header->magic, DMHM_FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+
+    this->width = width;
+    this->height = height;
+    last_band_top = height;
+    sequence = 0;
+    std::cerr << "Publishing frames to shared memory " << name << ", " << slot_count << " slots of " << width << "x" << height << std::endl;
+    return true;
+}
+
+void FrameRingPrivate::release() {
+    if(!mapping)
+        return;
+    /* Consumers see the ring has gone and reopen it by name */
+    __atomic_store_n(&header->writer_alive, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&header->latest, header->latest+1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &header->latest, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    munmap(mapping, mapping_size);
+    shm_unlink(name.c_str());
+    mapping = nullptr;
+    header = nullptr;
+    width = height = 0;
+}
+
+#else
+
+void FrameRing::publish(const uint32_t *bitmap, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top, bool repeated, std::chrono::steady_clock::time_point render_time) {
+    unused_arg(bitmap); unused_arg(stride); unused_arg(width); unused_arg(height);
+    unused_arg(band_top); unused_arg(repeated); unused_arg(render_time);
+    if(!p->failed) {
+        std::cerr << "Frame ring is only available on Linux" << std::endl;
+        p->failed = true;
+    }
+}
+
+bool FrameRingPrivate::create(uint32_t, uint32_t) {
+    return false;
+}
+
+void FrameRingPrivate::release() {
+}
+
+#endif
+
+dmhm_frame_slot *FrameRingPrivate::get_slot(uint64_t sequence) const {
+    return reinterpret_cast<dmhm_frame_slot *>(mapping + header->slot_offset + header->slot_size*(sequence % slot_count));
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#pragma once
+#include "../utils.h"
+#include <chrono>
+#include <cstdint>
+
+namespace dmhm {
+
+/* Publishes rendered frames into a POSIX shared memory ring, so that a local
+   consumer reads them without copying at the pace they are rendered.
+   The layout is described in frame_ring_format.h. Only available on Linux */
+class FrameRing {
+
+public:
+
+    FrameRing(const char *name, uint32_t slot_count);
+    ~FrameRing();
+    /* Copies the band into the next slot and wakes consumers.
+       A repeated frame is published again with an empty dirty rectangle */
+    void publish(const uint32_t *bitmap, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top, bool repeated, std::chrono::steady_clock::time_point render_time);
+
+private:
+
+    proxy_ptr<struct FrameRingPrivate> p;
+
+};
+
+}
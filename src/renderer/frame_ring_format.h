@@ -0,0 +1,74 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+/* Layout of the shared memory frame ring, see frame_ring.h.
+   Plain C so that consumers such as an OBS source plugin can include it.
+
+   The mapping starts with a dmhm_frame_ring_header, followed by slot_count
+   slots of slot_size bytes at slot_offset. Each slot is a dmhm_frame_slot
+   padded to DMHM_FRAME_SLOT_HEADER_SIZE bytes, followed by height rows of
+   stride bytes of premultiplied ARGB, native endian, the same as
+   CAIRO_FORMAT_ARGB32.
+
+   Frame n is written to slot n % slot_count. To read it, load the slot
+   sequence with acquire ordering, use the pixels, then load the sequence
+   again. The frame is intact if both equal n. The writer sets the sequence
+   to 0 before it touches a slot, so a consumer that falls more than
+   slot_count - 1 frames behind sees a mismatch and should move on to the
+   newest frame.
+
+   "latest" is a futex word holding the low 32 bits of the newest sequence.
+   Consumers increment "waiters" around FUTEX_WAIT on it, the writer only
+   calls FUTEX_WAKE when it is not zero. "writer_alive" drops to 0 when the
+   renderer exits or recreates the ring at a different size, consumers should
+   then unmap it and open it again by name. */
+
+#pragma once
+#include <stdint.h>
+
+#define DMHM_FRAME_RING_MAGIC UINT64_C(0x474e49524d484d44) /* "DMHMRING" in little endian */
+#define DMHM_FRAME_RING_VERSION 1
+#define DMHM_FRAME_SLOT_HEADER_SIZE 64
+
+struct dmhm_frame_ring_header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;         /* Bytes per row */
+    uint32_t slot_offset;    /* Bytes from the start of the mapping to the first slot */
+    uint64_t slot_size;      /* Bytes from one slot to the next, header included */
+    uint64_t latest_sequence;
+    uint32_t latest;         /* Futex word, low 32 bits of latest_sequence */
+    uint32_t waiters;
+    uint32_t writer_alive;
+    uint32_t writer_pid;     /* A ring whose writer has died without clearing writer_alive is stale */
+};
+
+struct dmhm_frame_slot {
+    uint64_t sequence;       /* Starts from 1, 0 while the slot is being written */
+    uint64_t render_ns;      /* CLOCK_MONOTONIC when the frame started rendering */
+    uint64_t publish_ns;     /* CLOCK_MONOTONIC when the frame was published */
+    uint32_t dirty_x;        /* Rectangle that differs from the previous frame, empty if the frame is repeated */
+    uint32_t dirty_y;
+    uint32_t dirty_width;
+    uint32_t dirty_height;
+    uint32_t band_top;       /* Rows above are transparent */
+    uint32_t reserved;
+};
@@ -0,0 +1,449 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "glyph_cache.h"
+#include "../utils.h"
+#include "../mapped_file.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "freetype_includer.h"
+
+namespace dmhm {
+
+/* Cache file layout, in host byte order:
+   GlyphCacheHeader, glyph_count * GlyphCacheRecord, data_size bytes of bitmaps.
+   Records are sorted by descending hit count, so the file also serves as
+   the frequency-ordered charset for the next run. */
+struct GlyphCacheHeader {
+    char magic[8];
+    uint64_t font_hash;
+    uint32_t font_file_index;
+    int32_t font_size; // In 26.6 fixed point
+    uint32_t glyph_count;
+    uint32_t data_size;
+};
+static_assert(sizeof (GlyphCacheHeader) == 32, "Unexpected padding in GlyphCacheHeader");
+
+struct GlyphCacheRecord {
+    uint32_t codepoint;
+    int32_t left;
+    int32_t top;
+    uint32_t width;
+    uint32_t height;
+    int32_t advance;
+    uint32_t offset;
+    uint32_t hits;
+};
+static_assert(sizeof (GlyphCacheRecord) == 32, "Unexpected padding in GlyphCacheRecord");
+
+static const char glyph_cache_magic[8] = {'D', 'M', 'H', 'M', 'G', 'C', '0', '1'};
+
+struct GlyphCachePrivate {
+    FT_Face face = nullptr;
+    uint32_t font_file_index = 0;
+    FT_F26Dot6 font_size = 0;
+    uint64_t font_hash = 0;
+    std::string cache_file;
+    std::string charset_file;
+    const uint8_t *font_data = nullptr;
+    size_t font_data_size = 0;
+    MappedFile cache_mapping;
+
+    std::mutex mutex;
+    std::unordered_map<uint32_t, Glyph> glyphs;
+    bool dirty = false;
+
+    bool prewarm_enabled = false;
+    std::thread worker;
+    std::condition_variable worker_cond;
+    bool worker_stopping = false;
+
+    void load_cache();
+    bool save_cache();
+    void do_work();
+    void prewarm(FT_Face prewarm_face);
+    static bool rasterize(FT_Face face, FT_F26Dot6 font_size, uint32_t codepoint, Glyph &glyph);
+    static uint64_t hash_font(const uint8_t *data, size_t size);
+};
+
+GlyphCache::GlyphCache(FT_Face face, const uint8_t *font_data, size_t font_data_size, uint32_t font_file_index, double font_size, const char *cache_file, const char *charset_file) {
+    p->face = face;
+    p->font_data = font_data;
+    p->font_data_size = font_data_size;
+    p->font_file_index = font_file_index;
+    p->font_size = FT_F26Dot6(font_size*64);
+    p->cache_file = cache_file ? cache_file : "";
+    p->prewarm_enabled = charset_file != nullptr;
+    p->charset_file = charset_file ? charset_file : "";
+
+    p->font_hash = p->hash_font(font_data, font_data_size);
+    if(!p->cache_file.empty())
+        p->load_cache();
+    p->worker = std::thread([&]() {
+        p->do_work();
+    });
+}
+
+GlyphCache::~GlyphCache() {
+    if(p->worker.joinable()) {
+        {
+            std::unique_lock<std::mutex> lock(p->mutex);
+            p->worker_stopping = true;
+        }
+        p->worker_cond.notify_all();
+        p->worker.join();
+    }
+    p->save_cache();
+}
+
+const Glyph *GlyphCache::get_glyph(uint32_t codepoint) {
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        auto it = p->glyphs.find(codepoint);
+        if(it != p->glyphs.end()) {
+            it->second.hits++;
+            return &it->second;
+        }
+    }
+    /* Rasterize outside the lock, the prewarm thread has its own face */
+    Glyph glyph;
+    p->rasterize(p->face, p->font_size, codepoint, glyph);
+    std::unique_lock<std::mutex> lock(p->mutex);
+    Glyph &result = p->glyphs.emplace(codepoint, std::move(glyph)).first->second;
+    result.hits++;
+    p->dirty = true;
+    return &result;
+}
+
+bool GlyphCache::save() {
+    return p->save_cache();
+}
+
+void GlyphCachePrivate::load_cache() {
+    /* A previous run may have failed to replace a file that was mapped */
+    replace_file((cache_file+".tmp").c_str(), cache_file.c_str());
+
+    if(!cache_mapping.open(cache_file.c_str()))
+        return;
+    const uint8_t *data = cache_mapping.data();
+    size_t size = cache_mapping.size();
+
+    GlyphCacheHeader header;
+    bool valid = size >= sizeof header;
+    if(valid) {
+        std::memcpy(&header, data, sizeof header);
+        valid = std::memcmp(header.magic, glyph_cache_magic, sizeof glyph_cache_magic) == 0 &&
+            header.font_hash == font_hash &&
+            header.font_file_index == font_file_index &&
+            header.font_size == font_size &&
+            uint64_t(sizeof header) + uint64_t(header.glyph_count)*sizeof (GlyphCacheRecord) + header.data_size <= size;
+    }
+    if(!valid) {
+        /* Stale cache from another font or size, will be overwritten */
+        cache_mapping.close();
+        return;
+    }
+
+    const uint8_t *records = data + sizeof header;
+    const uint8_t *bitmaps = records + size_t(header.glyph_count)*sizeof (GlyphCacheRecord);
+    std::unique_lock<std::mutex> lock(mutex);
+    glyphs.reserve(header.glyph_count);
+    for(uint32_t i = 0; i < header.glyph_count; i++) {
+        GlyphCacheRecord record;
+        std::memcpy(&record, records + size_t(i)*sizeof record, sizeof record);
+        if(uint64_t(record.offset) + uint64_t(record.width)*record.height > header.data_size)
+            continue;
+        Glyph glyph;
+        glyph.left = record.left;
+        glyph.top = record.top;
+        glyph.width = record.width;
+        glyph.height = record.height;
+        glyph.advance = record.advance;
+        glyph.bitmap = bitmaps + record.offset;
+        glyph.hits = record.hits;
+        glyphs.emplace(record.codepoint, std::move(glyph));
+    }
+    std::cerr << "Glyph cache: " << glyphs.size() << " glyphs loaded from " << cache_file << std::endl;
+}
+
+bool GlyphCachePrivate::save_cache() {
+    if(cache_file.empty() || font_hash == 0)
+        return false;
+
+    /* Glyphs are never removed and their bitmaps never change,
+       so the pointers can be used after the lock is released */
+    std::vector<std::pair<uint32_t, const Glyph *>> entries;
+    std::vector<uint32_t> hits;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(!dirty)
+            return true;
+        dirty = false;
+        entries.reserve(glyphs.size());
+        for(const auto &i : glyphs)
+            entries.push_back(std::make_pair(i.first, &i.second));
+        std::sort(entries.begin(), entries.end(), [](const std::pair<uint32_t, const Glyph *> &a, const std::pair<uint32_t, const Glyph *> &b) {
+            return a.second->hits != b.second->hits ? a.second->hits > b.second->hits : a.first < b.first;
+        });
+        hits.reserve(entries.size());
+        for(const auto &i : entries)
+            hits.push_back(i.second->hits);
+    }
+
+    GlyphCacheHeader header;
+    std::memcpy(header.magic, glyph_cache_magic, sizeof glyph_cache_magic);
+    header.font_hash = font_hash;
+    header.font_file_index = font_file_index;
+    header.font_size = int32_t(font_size);
+    header.glyph_count = uint32_t(entries.size());
+    header.data_size = 0;
+    std::vector<GlyphCacheRecord> records(entries.size());
+    for(size_t i = 0; i < entries.size(); i++) {
+        const Glyph &glyph = *entries[i].second;
+        records[i].codepoint = entries[i].first;
+        records[i].left = glyph.left;
+        records[i].top = glyph.top;
+        records[i].width = glyph.width;
+        records[i].height = glyph.height;
+        records[i].advance = glyph.advance;
+        records[i].offset = header.data_size;
+        records[i].hits = hits[i];
+        header.data_size += glyph.width*glyph.height;
+    }
+
+    std::string tmp_file = cache_file+".tmp";
+    FILE *file = std::fopen(tmp_file.c_str(), "wb");
+    if(!file)
+        return false;
+    bool success = std::fwrite(&header, sizeof header, 1, file) == 1;
+    if(success && !records.empty())
+        success = std::fwrite(records.data(), sizeof records[0], records.size(), file) == records.size();
+    for(size_t i = 0; success && i < entries.size(); i++) {
+        const Glyph &glyph = *entries[i].second;
+        size_t bitmap_size = size_t(glyph.width)*glyph.height;
+        if(bitmap_size != 0)
+            success = std::fwrite(glyph.bitmap, 1, bitmap_size, file) == bitmap_size;
+    }
+    success = std::fclose(file) == 0 && success;
+    if(!success) {
+        std::remove(tmp_file.c_str());
+        return false;
+    }
+    /* On Windows this fails while the old file is mapped,
+       the temporary file is then picked up on next startup */
+    return replace_file(tmp_file.c_str(), cache_file.c_str());
+}
+
+void GlyphCachePrivate::do_work() {
+    FT_Library prewarm_library = nullptr;
+    FT_Face prewarm_face = nullptr;
+    if(prewarm_enabled && FT_Init_FreeType(&prewarm_library) == 0) {
+        if(FT_New_Memory_Face(prewarm_library, font_data, FT_Long(font_data_size), FT_Long(font_file_index), &prewarm_face) == 0 &&
+            set_face_size(prewarm_face, double(font_size)/64) == 0)
+            prewarm(prewarm_face);
+        if(prewarm_face)
+            FT_Done_Face(prewarm_face);
+        FT_Done_FreeType(prewarm_library);
+    }
+
+    /* Flush new glyphs to disk now and then,
+       since the process usually ends without unwinding */
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!worker_stopping) {
+        worker_cond.wait_for(lock, std::chrono::seconds(30));
+        if(!worker_stopping && dirty) {
+            lock.unlock();
+            save_cache();
+            lock.lock();
+        }
+    }
+}
+
+void GlyphCachePrivate::prewarm(FT_Face prewarm_face) {
+    std::u32string charset;
+    if(!charset_file.empty()) {
+        std::ifstream charset_stream(charset_file, std::ios::binary);
+        if(charset_stream)
+            charset = utf8_to_ucs4(std::string(std::istreambuf_iterator<char>(charset_stream), std::istreambuf_iterator<char>()));
+    }
+    for(char32_t i = 0x20; i < 0x7f; i++)
+        charset.push_back(i);
+    charset += utf8_to_ucs4(common_charset);
+
+    for(char32_t codepoint : charset) {
+        if(codepoint < 0x20)
+            continue;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if(worker_stopping)
+                return;
+            if(glyphs.count(uint32_t(codepoint)) != 0)
+                continue;
+        }
+        Glyph glyph;
+        rasterize(prewarm_face, font_size, uint32_t(codepoint), glyph);
+        std::unique_lock<std::mutex> lock(mutex);
+        if(glyphs.emplace(uint32_t(codepoint), std::move(glyph)).second)
+            dirty = true;
+    }
+}
+
+FT_Error set_face_size(FT_Face face, double font_size) {
+    if(FT_IS_SCALABLE(face) || face->num_fixed_sizes == 0)
+        return FT_Set_Char_Size(face, 0, FT_F26Dot6(font_size*64), 72, 72);
+    /* Scaling down looks better than scaling up, so the smallest strike that is large enough */
+    FT_Pos wanted = FT_Pos(font_size*64);
+    FT_Int best = 0;
+    for(FT_Int i = 1; i < face->num_fixed_sizes; i++) {
+        FT_Pos size = face->available_sizes[i].y_ppem;
+        FT_Pos best_size = face->available_sizes[best].y_ppem;
+        bool is_better = best_size < wanted ? size > best_size : size >= wanted && size < best_size;
+        if(is_better)
+            best = i;
+    }
+    return FT_Select_Size(face, best);
+}
+
+/* Each destination pixel is the average of the source area under it */
+static void resize_coverage(const uint8_t *src, uint32_t src_width, uint32_t src_height, uint8_t *dst, uint32_t dst_width, uint32_t dst_height) {
+    auto weight = [](uint32_t i, double begin, double end) {
+        return std::min(end, i+1.0) - std::max(begin, double(i));
+    };
+    std::vector<double> columns(size_t(src_height)*dst_width);
+    double x_ratio = double(src_width)/dst_width;
+    for(uint32_t x = 0; x < dst_width; x++) {
+        double begin = x*x_ratio;
+        double end = (x+1)*x_ratio;
+        for(uint32_t y = 0; y < src_height; y++) {
+            double sum = 0;
+            for(uint32_t i = uint32_t(begin); i < src_width && i < end; i++)
+                sum += src[size_t(y)*src_width+i] * weight(i, begin, end);
+            columns[size_t(y)*dst_width+x] = sum/x_ratio;
+        }
+    }
+    double y_ratio = double(src_height)/dst_height;
+    for(uint32_t y = 0; y < dst_height; y++) {
+        double begin = y*y_ratio;
+        double end = (y+1)*y_ratio;
+        for(uint32_t x = 0; x < dst_width; x++) {
+            double sum = 0;
+            for(uint32_t i = uint32_t(begin); i < src_height && i < end; i++)
+                sum += columns[size_t(i)*dst_width+x] * weight(i, begin, end);
+            dst[size_t(y)*dst_width+x] = uint8_t(std::min(sum/y_ratio+0.5, 255.0));
+        }
+    }
+}
+
+bool GlyphCachePrivate::rasterize(FT_Face face, FT_F26Dot6 font_size, uint32_t codepoint, Glyph &glyph) {
+    FT_UInt glyph_index = FT_Get_Char_Index(face, FT_ULong(codepoint));
+    /* Color glyphs come as BGRA, only their alpha is used */
+    if(FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_HINTING | FT_LOAD_TARGET_NORMAL | FT_LOAD_COLOR) != 0)
+        return false;
+    FT_GlyphSlot slot = face->glyph;
+    /* Glyphs of a fixed size strike are scaled to font_size */
+    double scale = 1;
+    if(!FT_IS_SCALABLE(face) && face->size->metrics.y_ppem != 0)
+        scale = double(font_size) / (face->size->metrics.y_ppem*64);
+    /* Unhinted metrics, same as CAIRO_HINT_METRICS_OFF */
+    if(FT_IS_SCALABLE(face))
+        glyph.advance = int32_t((slot->linearHoriAdvance + 0x200) >> 10);
+    else
+        glyph.advance = int32_t(std::lround(slot->advance.x*scale));
+    if(slot->format != FT_GLYPH_FORMAT_BITMAP && FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0)
+        return false;
+
+    const FT_Bitmap &bitmap = slot->bitmap;
+    glyph.left = slot->bitmap_left;
+    glyph.top = slot->bitmap_top;
+    glyph.width = bitmap.width;
+    glyph.height = bitmap.rows;
+    if(glyph.width == 0 || glyph.height == 0) {
+        glyph.width = 0;
+        glyph.height = 0;
+        return true;
+    }
+    glyph.storage.reset(new uint8_t[size_t(glyph.width)*glyph.height]);
+    for(uint32_t i = 0; i < glyph.height; i++) {
+        const uint8_t *src = bitmap.buffer + ptrdiff_t(i)*bitmap.pitch;
+        uint8_t *dst = glyph.storage.get() + size_t(i)*glyph.width;
+        for(uint32_t j = 0; j < glyph.width; j++)
+            switch(bitmap.pixel_mode) {
+            case FT_PIXEL_MODE_GRAY:
+                dst[j] = uint8_t(uint32_t(src[j])*255/(bitmap.num_grays-1));
+                break;
+            case FT_PIXEL_MODE_MONO:
+                dst[j] = (src[j >> 3] & (0x80 >> (j & 7))) ? 0xff : 0;
+                break;
+            case FT_PIXEL_MODE_BGRA:
+                dst[j] = src[j*4 + 3];
+                break;
+            default:
+                dst[j] = 0;
+            }
+    }
+    if(scale != 1) {
+        uint32_t width = std::max(uint32_t(std::lround(glyph.width*scale)), uint32_t(1));
+        uint32_t height = std::max(uint32_t(std::lround(glyph.height*scale)), uint32_t(1));
+        std::unique_ptr<uint8_t[]> storage(new uint8_t[size_t(width)*height]);
+        resize_coverage(glyph.storage.get(), glyph.width, glyph.height, storage.get(), width, height);
+        glyph.storage = std::move(storage);
+        glyph.left = int32_t(std::lround(glyph.left*scale));
+        glyph.top = int32_t(std::lround(glyph.top*scale));
+        glyph.width = width;
+        glyph.height = height;
+    }
+    glyph.bitmap = glyph.storage.get();
+    return true;
+}
+
+/* FNV-1a over the file size, the first and the last 64 KiB.
+   Hashing the whole of a 20 MB font would cost more than the cache saves. */
+uint64_t GlyphCachePrivate::hash_font(const uint8_t *data, size_t size) {
+    const size_t sample_size = 65536;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto feed = [&](const uint8_t *buf, size_t len) {
+        for(size_t i = 0; i < len; i++) {
+            hash ^= buf[i];
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    uint64_t size64 = size;
+    feed(reinterpret_cast<const uint8_t *>(&size64), sizeof size64);
+    if(size <= 2*sample_size)
+        feed(data, size);
+    else {
+        feed(data, sample_size);
+        feed(data+size-sample_size, sample_size);
+    }
+    return hash != 0 ? hash : 1;
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include "freetype_includer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dmhm {
+
+struct Glyph {
+    int32_t left = 0;   // From pen position to the left column of bitmap, in pixels
+    int32_t top = 0;    // From baseline to the top row of bitmap, in pixels
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t advance = 0; // In 26.6 fixed point
+    const uint8_t *bitmap = nullptr; // 8-bit coverage, width*height, no padding
+    uint32_t hits = 0;
+    std::unique_ptr<uint8_t[]> storage; // Empty if bitmap lives in the cache file
+};
+
+struct GlyphRun {
+    struct Item {
+        const Glyph *glyph;
+        int32_t pen_x; // In 26.6 fixed point
+    };
+    std::vector<Item> items;
+    int32_t ink_top = 0;
+    int32_t ink_bottom = 0;
+    int32_t advance = 0; // In 26.6 fixed point
+};
+
+/* Rasterized glyphs of one font face at one size.
+   Glyphs are persisted to cache_file, which is memory-mapped on startup,
+   and a background thread rasterizes common characters ahead of time,
+   unless charset_file is nullptr.
+   font_data must outlive the cache.
+   Returned pointers stay valid until the cache is destroyed. */
+class GlyphCache {
+
+public:
+
+    GlyphCache(FT_Face face, const uint8_t *font_data, size_t font_data_size, uint32_t font_file_index, double font_size, const char *cache_file, const char *charset_file);
+    ~GlyphCache();
+    const Glyph *get_glyph(uint32_t codepoint);
+    bool save();
+
+private:
+
+    proxy_ptr<struct GlyphCachePrivate> p;
+
+};
+
+/* Sets the size of face to font_size pixels. A face with fixed sizes only, such as a
+   color emoji font, gets its nearest strike, and GlyphCache scales its glyphs to font_size */
+FT_Error set_face_size(FT_Face face, double font_size);
+
+extern const char *const common_charset;
+
+}
@@ -0,0 +1,240 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "offline_render.h"
+#include "../utils.h"
+#include "../app.h"
+#include "../config.h"
+#include "../mapped_file.h"
+#include "cairo_render.h"
+#include "danmaku_entry.h"
+#include "font_chain.h"
+#include "prerasterizer.h"
+#include "video_sink.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dmhm {
+
+/* Frames painted in a row by one renderer, so scrolling can reuse the last frame */
+static const uint32_t offline_chunk_frames = 8;
+
+/* Only the band is kept, rows above it are transparent */
+struct OfflineFrame {
+    uint32_t band_top = 0;
+    std::vector<uint32_t> band;
+};
+
+struct OfflineRendererPrivate {
+    Application *app = nullptr;
+    std::unique_ptr<FontChain> font_chain;
+    std::vector<PreparedDanmaku> timeline;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t fps = 0;
+    uint64_t frame_count = 0;
+    uint64_t chunk_count = 0;
+
+    /* Workers take chunks in order, but stay within chunk_window of the writer */
+    std::mutex mutex;
+    std::condition_variable chunk_done;
+    std::condition_variable chunk_written;
+    uint64_t next_chunk = 0;
+    uint64_t written_chunks = 0;
+    uint64_t chunk_window = 0;
+    std::map<uint64_t, std::vector<OfflineFrame>> finished_chunks;
+
+    bool load_fonts();
+    bool load_timeline();
+    std::chrono::steady_clock::time_point get_frame_time(uint64_t frame) const;
+    void do_work();
+};
+
+OfflineRenderer::OfflineRenderer(Application *app) {
+    p->app = app;
+}
+
+OfflineRenderer::~OfflineRenderer() {
+}
+
+int OfflineRenderer::run() {
+    dmhm_assert(*config::video_output != '\0');
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    if(!p->load_fonts() || !p->load_timeline())
+        return 1;
+
+    p->width = config::stage_width;
+    p->height = config::offline_stage_height;
+    p->fps = config::video_fps != 0 ? config::video_fps : config::max_fps;
+    /* Until the last line has faded out */
+    double duration = p->timeline.empty() ? 0 : std::chrono::duration<double>(p->timeline.back().entry.timestamp.time_since_epoch()).count() + config::danmaku_lifetime;
+    p->frame_count = uint64_t(std::ceil(duration*p->fps)) + 1;
+    p->chunk_count = (p->frame_count + offline_chunk_frames-1) / offline_chunk_frames;
+
+    uint32_t threads = config::render_threads != 0 ? config::render_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    p->chunk_window = uint64_t(threads)*2;
+    std::cerr << "Offline: " << p->timeline.size() << " lines, " << p->frame_count << " frames of " << p->width << "x" << p->height << " at " << p->fps << " fps, on " << threads << " threads" << std::endl;
+
+    VideoSink video_sink(config::video_output, config::video_format, p->fps, config::video_queue_frames);
+    std::vector<std::thread> workers;
+    for(uint32_t i = 0; i < threads; i++)
+        workers.push_back(std::thread([&]() {
+            p->do_work();
+        }));
+
+    std::chrono::steady_clock::time_point progress_checkpoint = std::chrono::steady_clock::now();
+    for(uint64_t chunk = 0; chunk < p->chunk_count; chunk++) {
+        std::vector<OfflineFrame> frames;
+        {
+            std::unique_lock<std::mutex> lock(p->mutex);
+            p->chunk_done.wait(lock, [&]() {
+                return p->finished_chunks.count(chunk) != 0;
+            });
+            frames = std::move(p->finished_chunks[chunk]);
+            p->finished_chunks.erase(chunk);
+        }
+        for(const OfflineFrame &frame : frames)
+            video_sink.write_frame(frame.band.data(), p->width, p->width, p->height, frame.band_top);
+        {
+            std::unique_lock<std::mutex> lock(p->mutex);
+            p->written_chunks = chunk+1;
+        }
+        p->chunk_written.notify_all();
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if(now-progress_checkpoint >= std::chrono::seconds(10)) {
+            uint64_t frames_written = std::min((chunk+1)*offline_chunk_frames, p->frame_count);
+            std::cerr << "Offline: " << frames_written << " of " << p->frame_count << " frames, " << frames_written/std::chrono::duration<double>(now-start_time).count() << " fps" << std::endl;
+            progress_checkpoint = now;
+        }
+    }
+    for(std::thread &i : workers)
+        i.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start_time).count();
+    std::cerr << "Offline: " << p->frame_count << " frames in " << seconds << " s, " << p->frame_count/seconds << " fps, " << p->frame_count/seconds/p->fps << "x real time" << std::endl;
+    return 0;
+}
+
+bool OfflineRendererPrivate::load_fonts() {
+    font_chain.reset(new FontChain);
+    FT_Error ft_error = font_chain->open_primary(config::font_file, config::font_file_index);
+    if(ft_error != 0) {
+        std::cerr << "Failed to open font file " << config::font_file << " (FreeType error " << ft_error << ")" << std::endl;
+        return false;
+    }
+    for(const std::string &i : config::fallback_font_files)
+        font_chain->add_fallback(i);
+    return true;
+}
+
+/* Laid out once up front, the renderers share the glyph runs */
+bool OfflineRendererPrivate::load_timeline() {
+    MappedFile file;
+    if(!file.open(config::offline_timeline)) {
+        std::cerr << "Failed to open timeline " << config::offline_timeline << std::endl;
+        return false;
+    }
+    const char *data = reinterpret_cast<const char *>(file.data());
+    const char *end = data + file.size();
+    uint32_t malformed = 0;
+    std::vector<std::pair<double, std::string>> lines;
+    std::string line;
+    while(data < end) {
+        const char *line_end = std::find(data, end, '\n');
+        line.assign(data, line_end);
+        data = line_end == end ? end : line_end+1;
+        if(!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if(line.empty())
+            continue;
+        char *number_end;
+        double seconds = std::strtod(line.c_str(), &number_end);
+        if(number_end == line.c_str() || (*number_end != ' ' && *number_end != '\t') || !(seconds >= 0 && seconds < 1e9)) {
+            malformed++;
+            continue;
+        }
+        lines.push_back(std::make_pair(seconds, utf8_validify(std::string(number_end+1))));
+    }
+    if(malformed != 0)
+        std::cerr << "Offline: skipped " << malformed << " lines without a time in " << config::offline_timeline << std::endl;
+    std::stable_sort(lines.begin(), lines.end(), [](const std::pair<double, std::string> &a, const std::pair<double, std::string> &b) {
+        return a.first < b.first;
+    });
+
+    timeline.reserve(lines.size());
+    for(std::pair<double, std::string> &i : lines) {
+        timeline.push_back(PreparedDanmaku(DanmakuEntry(i.second, std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(i.first))))));
+        PreparedDanmaku &message = timeline.back();
+        font_chain->layout_text(message.entry.message, message.glyph_run);
+    }
+    return true;
+}
+
+std::chrono::steady_clock::time_point OfflineRendererPrivate::get_frame_time(uint64_t frame) const {
+    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(int64_t(frame*1000000000/fps))));
+}
+
+/* Each worker moves forward through the timeline only, so it replays each line once
+   however many chunks it skips over */
+void OfflineRendererPrivate::do_work() {
+    CairoRenderer renderer(timeline);
+    for(;;) {
+        uint64_t chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunk_written.wait(lock, [&]() {
+                return next_chunk >= chunk_count || next_chunk < written_chunks+chunk_window;
+            });
+            if(next_chunk >= chunk_count)
+                return;
+            chunk = next_chunk++;
+        }
+
+        uint64_t first_frame = chunk*offline_chunk_frames;
+        uint64_t last_frame = std::min(first_frame+offline_chunk_frames, frame_count);
+        std::vector<OfflineFrame> frames(last_frame-first_frame);
+        for(uint64_t i = first_frame; i < last_frame; i++)
+            renderer.paint_frame_at(width, height, get_frame_time(i), [&](const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+                OfflineFrame &frame = frames[i-first_frame];
+                frame.band_top = band_top;
+                frame.band.resize(size_t(width)*band_height);
+                for(uint32_t row = 0; row < band_height; row++)
+                    std::copy(&bitmap[size_t(band_top+row)*stride], &bitmap[size_t(band_top+row)*stride+width], &frame.band[size_t(row)*width]);
+            });
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished_chunks[chunk] = std::move(frames);
+        }
+        chunk_done.notify_one();
+    }
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#pragma once
+
+#include "../utils.h"
+#include "../app.h"
+
+namespace dmhm {
+
+/* Renders a recorded chat log into video_output as fast as the cores allow.
+   Each line of offline_timeline is a time in seconds from the start, a space
+   or a tab, then the message. Since lines arrive at their own timestamps,
+   the stage at any time depends on the timeline alone, so runs of frames are
+   painted by one CairoRenderer per core and written in order */
+class OfflineRenderer {
+
+public:
+
+    OfflineRenderer(Application *app);
+    ~OfflineRenderer();
+    int run();
+
+private:
+
+    proxy_ptr<struct OfflineRendererPrivate> p;
+
+};
+
+}
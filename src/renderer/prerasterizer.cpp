@@ -0,0 +1,113 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "prerasterizer.h"
+#include "../utils.h"
+#include "../app.h"
+#include "../fetcher/fetcher.h"
+#include "danmaku_entry.h"
+#include "font_chain.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+
+namespace dmhm {
+
+/* Messages prepared but not taken by the renderer yet, past this the thread stops taking
+   messages from the fetcher, so its own limits hold the producers back */
+static const size_t prepared_queue_cap = 64;
+
+struct PrerasterizerPrivate {
+    Application *app = nullptr;
+    FontChain *font_chain = nullptr;
+    std::thread thread;
+    std::atomic<bool> stopping = {false};
+    std::atomic<bool> is_eof = {false};
+    std::mutex mutex;
+    std::condition_variable queue_not_full;
+    std::list<PreparedDanmaku> prepared_queue;
+    void do_run();
+};
+
+Prerasterizer::Prerasterizer(Application *app, FontChain *font_chain) {
+    p->app = app;
+    p->font_chain = font_chain;
+    p->thread = std::thread([&]() {
+        p->do_run();
+    });
+}
+
+Prerasterizer::~Prerasterizer() {
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        p->stopping = true;
+    }
+    p->queue_not_full.notify_one();
+    p->thread.join();
+}
+
+bool Prerasterizer::is_eof() {
+    return p->is_eof;
+}
+
+void Prerasterizer::pop_messages(std::function<void (PreparedDanmaku &message)> callback) {
+    std::list<PreparedDanmaku> messages;
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        messages.swap(p->prepared_queue);
+    }
+    p->queue_not_full.notify_one();
+    for(PreparedDanmaku &i : messages)
+        callback(i);
+}
+
+void PrerasterizerPrivate::do_run() {
+    Fetcher *fetcher = reinterpret_cast<Fetcher *>(app->get_fetcher());
+    dmhm_assert(fetcher);
+
+    /* Wakes up now and then to notice the destructor */
+    while(!stopping) {
+        fetcher->wait_messages(std::chrono::milliseconds(100));
+        bool fetcher_eof = fetcher->is_eof();
+        std::list<PreparedDanmaku> messages;
+        fetcher->pop_messages([&](DanmakuEntry &entry) {
+            messages.push_back(PreparedDanmaku(std::move(entry)));
+        });
+        /* Each message is handed over as soon as it is ready, not the whole burst */
+        while(!messages.empty()) {
+            font_chain->layout_text(messages.front().entry.message, messages.front().glyph_run);
+            std::unique_lock<std::mutex> lock(mutex);
+            queue_not_full.wait(lock, [&]() {
+                return stopping || prepared_queue.size() < prepared_queue_cap;
+            });
+            if(stopping)
+                return;
+            prepared_queue.splice(prepared_queue.end(), messages, messages.begin());
+        }
+        if(fetcher_eof) {
+            is_eof = true;
+            return;
+        }
+    }
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#pragma once
+
+#include "../utils.h"
+#include "../app.h"
+#include "danmaku_entry.h"
+#include "font_chain.h"
+#include "glyph_cache.h"
+#include <functional>
+
+namespace dmhm {
+
+/* A message laid out and with its glyphs rasterized, ready to animate */
+struct PreparedDanmaku {
+    PreparedDanmaku(DanmakuEntry &&entry) :
+        entry(std::move(entry)) {
+    }
+    DanmakuEntry entry;
+    GlyphRun glyph_run;
+};
+
+/* Takes messages from the fetcher and lays them out on a thread of its own,
+   so a burst of messages costs the rendering thread nothing but the hand-over.
+   From construction until destruction, that thread is the only user of font_chain. */
+class Prerasterizer {
+
+public:
+
+    Prerasterizer(Application *app, FontChain *font_chain);
+    ~Prerasterizer();
+    /* True once the fetcher reached the end and every message was prepared */
+    bool is_eof();
+    void pop_messages(std::function<void (PreparedDanmaku &message)> callback);
+
+private:
+
+    proxy_ptr<struct PrerasterizerPrivate> p;
+
+};
+
+}
@@ -0,0 +1,109 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "quality_governor.h"
+#include "../utils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace dmhm {
+
+static const uint32_t overload_windows_needed = 2;
+static const uint32_t min_calm_windows = 5;
+static const uint32_t max_calm_windows = 60;
+
+struct QualityGovernorPrivate {
+    std::vector<QualityTier> tiers;
+    size_t tier = 0;
+
+    /* Frames are averaged over windows of about one second */
+    std::chrono::steady_clock::duration budget;
+    uint32_t window_frames;
+    uint32_t frame_count = 0;
+    std::chrono::steady_clock::duration window_cost = std::chrono::steady_clock::duration::zero();
+
+    uint32_t overload_windows = 0;
+    uint32_t calm_windows = 0;
+    uint32_t calm_windows_needed = min_calm_windows;
+    uint32_t windows_since_step_up = max_calm_windows;
+
+    void end_window();
+    void change_tier(size_t new_tier, std::chrono::steady_clock::duration mean_cost);
+};
+
+QualityGovernor::QualityGovernor(const std::vector<QualityTier> &tiers, uint32_t max_fps) {
+    dmhm_assert(!tiers.empty());
+    dmhm_assert(max_fps != 0);
+    p->tiers = tiers;
+    p->budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1))/max_fps;
+    p->window_frames = max_fps;
+}
+
+QualityGovernor::~QualityGovernor() {
+}
+
+const QualityTier &QualityGovernor::get_tier() const {
+    return p->tiers[p->tier];
+}
+
+bool QualityGovernor::add_frame(std::chrono::steady_clock::duration cost) {
+    size_t old_tier = p->tier;
+    p->window_cost += cost;
+    if(++p->frame_count >= p->window_frames)
+        p->end_window();
+    return p->tier != old_tier;
+}
+
+void QualityGovernorPrivate::end_window() {
+    std::chrono::steady_clock::duration mean_cost = window_cost/frame_count;
+    frame_count = 0;
+    window_cost = std::chrono::steady_clock::duration::zero();
+    windows_since_step_up = std::min(windows_since_step_up+1, max_calm_windows);
+
+    /* Over 90% of the budget leaves nothing for the presenter and the rest of the desktop */
+    if(mean_cost*10 > budget*9) {
+        calm_windows = 0;
+        if(++overload_windows >= overload_windows_needed && tier+1 < tiers.size()) {
+            /* The last step up did not hold, be more careful next time */
+            if(windows_since_step_up <= calm_windows_needed)
+                calm_windows_needed = std::min(calm_windows_needed*2, max_calm_windows);
+            change_tier(tier+1, mean_cost);
+        }
+    } else if(mean_cost*2 < budget) {
+        overload_windows = 0;
+        if(++calm_windows >= calm_windows_needed && tier > 0) {
+            windows_since_step_up = 0;
+            change_tier(tier-1, mean_cost);
+        }
+    } else {
+        overload_windows = 0;
+        calm_windows = 0;
+    }
+}
+
+void QualityGovernorPrivate::change_tier(size_t new_tier, std::chrono::steady_clock::duration mean_cost) {
+    typedef std::chrono::duration<double, std::milli> milliseconds;
+    std::cerr << "Quality: " << tiers[tier].name << " -> " << tiers[new_tier].name << " (" << milliseconds(mean_cost).count() << " ms per frame, budget " << milliseconds(budget).count() << " ms)" << std::endl;
+    tier = new_tier;
+    overload_windows = 0;
+    calm_windows = 0;
+}
+
+}
@@ -0,0 +1,57 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#pragma once
+
+#include "../utils.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace dmhm {
+
+/* One step of rendering quality, the first tier is the full one */
+struct QualityTier {
+    const char *name;
+    uint32_t blur_rounds;       // Box blur rounds, out of blur_box_rounds
+    uint32_t shadow_downsample;
+    uint32_t frame_interval;    // Render one frame out of this many, show the last one in between
+    double radius_scale;        // Applied to shadow_radius for the blur only, not the layout
+};
+
+/* Watches how long frames take against the 1/max_fps budget.
+   Steps down a tier when frames overrun for a while, steps back up when
+   there is plenty of time left for longer, and waits twice as long each
+   time a step up had to be taken back. */
+class QualityGovernor {
+
+public:
+
+    QualityGovernor(const std::vector<QualityTier> &tiers, uint32_t max_fps);
+    ~QualityGovernor();
+    const QualityTier &get_tier() const;
+    /* Counts the time spent on one frame, returns true when the tier changes */
+    bool add_frame(std::chrono::steady_clock::duration cost);
+
+private:
+
+    proxy_ptr<struct QualityGovernorPrivate> p;
+
+};
+
+}
@@ -0,0 +1,108 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "shadow_stamp.h"
+#include "../utils.h"
+#include "blur.h"
+#include "glyph_cache.h"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace dmhm {
+
+struct ShadowStampEntry {
+    ShadowStamp stamp;
+    std::unique_ptr<uint16_t[]> storage;
+};
+
+struct ShadowStampCachePrivate {
+    uint32_t blur_boxes[blur_box_rounds];
+    int32_t padding = 0;
+    std::unordered_map<const Glyph *, ShadowStampEntry> stamps;
+    size_t memory_used = 0;
+    std::vector<uint32_t> scl;
+    std::vector<uint32_t> tcl;
+    /* Large radii make large stamps, start over if they pile up */
+    static const size_t memory_limit = 64*1024*1024;
+};
+
+ShadowStampCache::ShadowStampCache(const uint32_t boxes[blur_box_rounds]) {
+    std::copy(boxes, boxes+blur_box_rounds, p->blur_boxes);
+    /* Each box round spreads coverage by half its width */
+    for(uint32_t i = 0; i < blur_box_rounds; i++)
+        p->padding += int32_t(boxes[i]/2);
+}
+
+ShadowStampCache::~ShadowStampCache() {
+}
+
+const ShadowStamp *ShadowStampCache::get_stamp(const Glyph *glyph) {
+    auto it = p->stamps.find(glyph);
+    if(it != p->stamps.end())
+        return &it->second.stamp;
+
+    ShadowStampEntry entry;
+    if(glyph->width != 0 && glyph->height != 0) {
+        int32_t pad = p->padding;
+        int32_t w = int32_t(glyph->width) + 2*pad;
+        int32_t h = int32_t(glyph->height) + 2*pad;
+        p->scl.assign(size_t(w)*h, 0);
+        p->tcl.resize(size_t(w)*h);
+        for(uint32_t i = 0; i < glyph->height; i++)
+            for(uint32_t j = 0; j < glyph->width; j++)
+                p->scl[size_t(i+pad)*w + j+pad] = uint32_t(glyph->bitmap[i*glyph->width + j]) << 8;
+        /* Same kernel as the full stage blur, so both engines look alike */
+        gauss_blur_box(p->scl.data(), p->tcl.data(), w, h, p->blur_boxes);
+
+        entry.storage.reset(new uint16_t[size_t(w)*h]);
+        for(size_t i = 0; i < size_t(w)*h; i++)
+            entry.storage[i] = uint16_t(std::min(p->scl[i], uint32_t(0xffff)));
+        entry.stamp.left = glyph->left - pad;
+        entry.stamp.top = glyph->top + pad;
+        entry.stamp.width = uint32_t(w);
+        entry.stamp.height = uint32_t(h);
+        entry.stamp.coverage = entry.storage.get();
+        p->memory_used += size_t(w)*h*sizeof (uint16_t);
+    }
+    return &p->stamps.emplace(glyph, std::move(entry)).first->second.stamp;
+}
+
+void ShadowStampCache::trim() {
+    if(p->memory_used > p->memory_limit) {
+        p->stamps.clear();
+        p->memory_used = 0;
+    }
+}
+
+void ShadowStampCache::accumulate(uint32_t *plane, uint32_t stride, int32_t width, int32_t height, const ShadowStamp &stamp, int32_t left, int32_t top, uint32_t alpha_fixed) {
+    int32_t row_start = std::max(0, -top);
+    int32_t row_end = std::min(int32_t(stamp.height), height-top);
+    int32_t col_start = std::max(0, -left);
+    int32_t col_end = std::min(int32_t(stamp.width), width-left);
+    for(int32_t i = row_start; i < row_end; i++) {
+        const uint16_t *src = stamp.coverage + i*stamp.width;
+        uint32_t *dst = plane + (top+i)*stride + left;
+        for(int32_t j = col_start; j < col_end; j++)
+            dst[j] += (uint32_t(src[j])*alpha_fixed) >> 8;
+    }
+}
+
+}
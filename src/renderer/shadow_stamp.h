@@ -0,0 +1,59 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include "blur.h"
+#include "glyph_cache.h"
+#include <cstdint>
+
+namespace dmhm {
+
+struct ShadowStamp {
+    int32_t left = 0;   // Like Glyph::left, includes the blur padding
+    int32_t top = 0;    // Like Glyph::top, includes the blur padding
+    uint32_t width = 0;
+    uint32_t height = 0;
+    const uint16_t *coverage = nullptr; // Blurred glyph coverage, 8.8 fixed point
+};
+
+/* Pre-blurred shadows of glyphs at one blur size.
+   Since the blur is linear, the shadow of a line of text is the sum of the
+   stamps of its glyphs, which saves blurring the whole stage every frame. */
+class ShadowStampCache {
+
+public:
+
+    ShadowStampCache(const uint32_t boxes[blur_box_rounds]);
+    ~ShadowStampCache();
+    const ShadowStamp *get_stamp(const Glyph *glyph);
+    /* Drops all stamps if they take too much memory, call between frames
+       because stamps returned earlier are freed */
+    void trim();
+    /* Add stamp*alpha_fixed/256 to an 8.8 fixed point plane, clipped to it */
+    static void accumulate(uint32_t *plane, uint32_t stride, int32_t width, int32_t height, const ShadowStamp &stamp, int32_t left, int32_t top, uint32_t alpha_fixed);
+
+private:
+
+    proxy_ptr<struct ShadowStampCachePrivate> p;
+
+};
+
+}
@@ -0,0 +1,158 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#include "thread_pool.h"
+#include "../utils.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dmhm {
+
+struct ThreadPoolQueue {
+    std::mutex mutex;
+    std::deque<uint32_t> tasks;
+};
+
+struct ThreadPoolPrivate {
+    std::vector<std::thread> workers;
+    std::unique_ptr<ThreadPoolQueue[]> queues; // The last one belongs to the calling thread
+    uint32_t queue_count = 0;
+    const std::function<void (uint32_t index)> *task = nullptr;
+    std::atomic<uint32_t> remaining;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_cond;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    std::mutex done_mutex;
+    std::condition_variable done_cond;
+
+    void worker_loop(uint32_t queue_index);
+    void run_tasks(uint32_t queue_index);
+    bool pop_task(uint32_t queue_index, uint32_t &index);
+};
+
+ThreadPool::ThreadPool(uint32_t threads) {
+    dmhm_assert(threads >= 1);
+    p->remaining = 0;
+    p->queue_count = threads;
+    p->queues.reset(new ThreadPoolQueue[threads]);
+    for(uint32_t i = 0; i+1 < threads; i++)
+        p->workers.emplace_back([this, i]() {
+            p->worker_loop(i);
+        });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(p->wake_mutex);
+        p->stopping = true;
+    }
+    p->wake_cond.notify_all();
+    for(std::thread &i : p->workers)
+        i.join();
+}
+
+uint32_t ThreadPool::size() const {
+    return p->queue_count;
+}
+
+void ThreadPool::parallel_for(uint32_t count, const std::function<void (uint32_t index)> &task) {
+    if(count == 0)
+        return;
+    if(p->workers.empty()) {
+        for(uint32_t i = 0; i < count; i++)
+            task(i);
+        return;
+    }
+    p->task = &task;
+    p->remaining = count;
+    for(uint32_t i = 0; i < p->queue_count; i++) {
+        std::lock_guard<std::mutex> lock(p->queues[i].mutex);
+        for(uint32_t j = uint32_t(uint64_t(count)*i/p->queue_count); j < uint64_t(count)*(i+1)/p->queue_count; j++)
+            p->queues[i].tasks.push_back(j);
+    }
+    {
+        std::lock_guard<std::mutex> lock(p->wake_mutex);
+        p->generation++;
+    }
+    p->wake_cond.notify_all();
+
+    p->run_tasks(p->queue_count-1);
+    std::unique_lock<std::mutex> lock(p->done_mutex);
+    p->done_cond.wait(lock, [&]() {
+        return p->remaining == 0;
+    });
+}
+
+void ThreadPoolPrivate::worker_loop(uint32_t queue_index) {
+    uint64_t seen_generation = 0;
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake_cond.wait(lock, [&]() {
+                return stopping || generation != seen_generation;
+            });
+            if(stopping)
+                return;
+            seen_generation = generation;
+        }
+        run_tasks(queue_index);
+    }
+}
+
+void ThreadPoolPrivate::run_tasks(uint32_t queue_index) {
+    uint32_t index;
+    while(pop_task(queue_index, index)) {
+        /* The queue mutex orders this read after the task was set */
+        (*task)(index);
+        if(--remaining == 0) {
+            std::lock_guard<std::mutex> lock(done_mutex);
+            done_cond.notify_all();
+        }
+    }
+}
+
+/* Own pieces are taken from the front, stolen ones from the back */
+bool ThreadPoolPrivate::pop_task(uint32_t queue_index, uint32_t &index) {
+    for(uint32_t i = 0; i < queue_count; i++) {
+        ThreadPoolQueue &queue = queues[(queue_index+i) % queue_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.tasks.empty())
+            continue;
+        if(i == 0) {
+            index = queue.tasks.front();
+            queue.tasks.pop_front();
+        } else {
+            index = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,48 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+#pragma once
+
+#include "../utils.h"
+#include <cstdint>
+#include <functional>
+
+namespace dmhm {
+
+/* A small set of persistent threads for splitting a frame into pieces.
+   Each thread starts on its own contiguous share of the pieces,
+   then steals from the others when it runs out. */
+class ThreadPool {
+
+public:
+
+    /* The calling thread counts as one, so threads = 1 starts none */
+    ThreadPool(uint32_t threads);
+    ~ThreadPool();
+    uint32_t size() const;
+    /* Runs task(0) to task(count-1) and returns when all of them are done */
+    void parallel_for(uint32_t count, const std::function<void (uint32_t index)> &task);
+
+private:
+
+    proxy_ptr<struct ThreadPoolPrivate> p;
+
+};
+
+}
@@ -0,0 +1,356 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#include "video_sink.h"
+#include "../utils.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace dmhm {
+
+enum VideoFormat {
+    VIDEO_FORMAT_RGBA,
+    VIDEO_FORMAT_Y4M
+};
+
+static const struct {
+    const char *name;
+    VideoFormat format;
+} video_format_names[] = {
+    { "rgba", VIDEO_FORMAT_RGBA },
+    { "y4m", VIDEO_FORMAT_Y4M }
+};
+
+struct VideoFrame {
+    std::vector<uint32_t> pixels;
+    uint32_t band_top;  // Rows above are transparent
+    uint32_t repeat;    // Written this many times
+};
+
+struct VideoSinkPrivate {
+    std::string filename;
+    VideoFormat format = VIDEO_FORMAT_RGBA;
+    uint32_t fps;
+    uint32_t queue_frames;
+    FILE *file = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool started = false;
+    std::chrono::steady_clock::time_point start_time;
+    uint64_t frames_due = 0;  // Frame periods begun so far
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable queue_changed;
+    std::condition_variable queue_drained;
+    bool stopping = false;
+    std::deque<std::unique_ptr<VideoFrame>> queue;
+    std::vector<std::unique_ptr<VideoFrame>> free_frames;
+    std::vector<uint8_t> output;
+    /* Unpremultiply by multiplying with 255/alpha in 16.16 fixed point */
+    uint32_t reciprocal[256];
+
+    /* Since the last print_stats, under mutex */
+    uint64_t rendered = 0;
+    uint64_t written = 0;
+    uint64_t duplicated = 0;
+    uint64_t dropped = 0;
+    uint64_t dropped_behind = 0;
+    size_t max_queued = 0;
+    bool failed = false;
+    std::chrono::steady_clock::time_point stats_checkpoint;
+
+    void queue_frame(std::unique_ptr<VideoFrame> frame, uint32_t repeat, const uint32_t *band, uint32_t stride, uint32_t band_top);
+    void do_run();
+    void open_output(uint32_t width, uint32_t height);
+    void convert_rgba(const VideoFrame &frame);
+    void convert_y4m(const VideoFrame &frame);
+};
+
+bool is_valid_video_format(const char *name) {
+    for(const auto &i : video_format_names)
+        if(std::strcmp(name, i.name) == 0)
+            return true;
+    return false;
+}
+
+VideoSink::VideoSink(const char *filename, const char *format, uint32_t fps, uint32_t queue_frames) {
+    dmhm_assert(*filename != '\0');
+    dmhm_assert(fps > 0);
+    dmhm_assert(queue_frames > 0);
+    p->filename = filename;
+    for(const auto &i : video_format_names)
+        if(std::strcmp(format, i.name) == 0)
+            p->format = i.format;
+    p->fps = fps;
+    p->queue_frames = queue_frames;
+    p->reciprocal[0] = 0;
+    for(uint32_t a = 1; a < 256; a++)
+        p->reciprocal[a] = (255*65536 + a/2) / a;
+    p->stats_checkpoint = std::chrono::steady_clock::now();
+    p->thread = std::thread([&]() {
+        p->do_run();
+    });
+}
+
+/* What is still queued gets written before the file is closed */
+VideoSink::~VideoSink() {
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        p->stopping = true;
+    }
+    p->queue_changed.notify_one();
+    p->thread.join();
+    if(p->file) {
+        std::cerr << "Video: " << p->width << "x" << p->height << " at " << p->fps << " fps to " << p->filename << " closed" << std::endl;
+        if(p->file != stdout)
+            std::fclose(p->file);
+        else
+            std::fflush(p->file);
+    }
+}
+
+void VideoSink::push_frame(const uint32_t *bitmap, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top, std::chrono::steady_clock::time_point render_time) {
+    if(!p->started) {
+        p->started = true;
+        p->start_time = render_time;
+        p->width = width;
+        p->height = height;
+    }
+    /* The stream has a fixed size, unlike the stage */
+    if(width != p->width || height != p->height)
+        return;
+
+    /* Frame n covers the period starting at start_time + n/fps */
+    uint64_t frames_due = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(render_time-p->start_time).count())*p->fps/1000000 + 1;
+    std::unique_ptr<VideoFrame> frame;
+    uint32_t repeat;
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        p->rendered++;
+        if(frames_due <= p->frames_due) {
+            /* Rendered faster than the stream needs */
+            p->dropped++;
+            return;
+        }
+        repeat = uint32_t(std::min<uint64_t>(frames_due-p->frames_due, UINT32_MAX));
+        p->frames_due = frames_due;
+        if(p->queue.size() >= p->queue_frames) {
+            /* The writer is behind, keep the stream in time by repeating the last queued frame */
+            p->queue.back()->repeat += repeat;
+            p->duplicated += repeat;
+            p->dropped++;
+            p->dropped_behind++;
+            return;
+        }
+        p->duplicated += repeat-1;
+        if(!p->free_frames.empty()) {
+            frame = std::move(p->free_frames.back());
+            p->free_frames.pop_back();
+        }
+    }
+    p->queue_frame(std::move(frame), repeat, bitmap + size_t(band_top)*stride, stride, band_top);
+}
+
+void VideoSink::write_frame(const uint32_t *band, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top) {
+    if(!p->started) {
+        p->started = true;
+        p->width = width;
+        p->height = height;
+    }
+    dmhm_assert(width == p->width && height == p->height);
+
+    std::unique_ptr<VideoFrame> frame;
+    {
+        std::unique_lock<std::mutex> lock(p->mutex);
+        p->queue_drained.wait(lock, [&]() {
+            return p->queue.size() < p->queue_frames;
+        });
+        p->rendered++;
+        p->frames_due++;
+        if(!p->free_frames.empty()) {
+            frame = std::move(p->free_frames.back());
+            p->free_frames.pop_back();
+        }
+    }
+    p->queue_frame(std::move(frame), 1, band, stride, band_top);
+}
+
+void VideoSink::print_stats(std::chrono::steady_clock::time_point now) {
+    if(now-p->stats_checkpoint < std::chrono::seconds(10))
+        return;
+    std::unique_lock<std::mutex> lock(p->mutex);
+    if(p->started)
+        std::cerr << "Video: " << p->rendered << " rendered, " << p->written << " written, " << p->duplicated << " duplicated, "
+            << p->dropped << " dropped (" << p->dropped_behind << " while the writer was behind), at most " << p->max_queued << " queued" << std::endl;
+    p->rendered = p->written = p->duplicated = p->dropped = p->dropped_behind = 0;
+    p->max_queued = 0;
+    p->stats_checkpoint = now;
+}
+
+/* Copies the band into a pooled buffer, or a new one if frame is empty, and hands it to the writer */
+void VideoSinkPrivate::queue_frame(std::unique_ptr<VideoFrame> frame, uint32_t repeat, const uint32_t *band, uint32_t stride, uint32_t band_top) {
+    if(!frame) {
+        frame.reset(new VideoFrame);
+        frame->pixels.assign(size_t(width)*height, 0);
+        frame->band_top = height;
+    }
+    frame->repeat = repeat;
+    /* The buffer last held an older frame, clear whatever it had above the band */
+    for(uint32_t row = std::min(frame->band_top, band_top); row < band_top; row++)
+        std::fill(&frame->pixels[size_t(row)*width], &frame->pixels[size_t(row)*width+width], 0);
+    for(uint32_t row = band_top; row < height; row++)
+        std::copy(&band[size_t(row-band_top)*stride], &band[size_t(row-band_top)*stride+width], &frame->pixels[size_t(row)*width]);
+    frame->band_top = band_top;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queue.push_back(std::move(frame));
+        max_queued = std::max(max_queued, queue.size());
+    }
+    queue_changed.notify_one();
+}
+
+void VideoSinkPrivate::do_run() {
+    for(;;) {
+        std::unique_ptr<VideoFrame> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queue_changed.wait(lock, [&]() {
+                return stopping || !queue.empty();
+            });
+            if(queue.empty())
+                return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        queue_drained.notify_one();
+
+        if(!file && !failed)
+            open_output(width, height);
+        if(file) {
+            if(format == VIDEO_FORMAT_Y4M)
+                convert_y4m(*frame);
+            else
+                convert_rgba(*frame);
+            for(uint32_t i = 0; i < frame->repeat && file; i++)
+                if(std::fwrite(output.data(), 1, output.size(), file) != output.size()) {
+                    std::cerr << "Failed to write video to " << filename << ": " << std::strerror(errno) << std::endl;
+                    if(file != stdout)
+                        std::fclose(file);
+                    file = nullptr;
+                }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if(file)
+            written += frame->repeat;
+        else
+            failed = true;
+        free_frames.push_back(std::move(frame));
+    }
+}
+
+/* Opened by the writer, since opening a FIFO blocks until the reader appears */
+void VideoSinkPrivate::open_output(uint32_t width, uint32_t height) {
+    if(filename == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        file = stdout;
+    } else {
+#ifdef _WIN32
+        file = _wfopen(utf8_to_wide(filename).c_str(), L"wb");
+#else
+        file = std::fopen(filename.c_str(), "wb");
+#endif
+    }
+    if(!file) {
+        std::cerr << "Failed to open video output " << filename << ": " << std::strerror(errno) << std::endl;
+        failed = true;
+        return;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1048576);
+    if(format == VIDEO_FORMAT_Y4M)
+        std::fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444alpha\n", width, height, fps);
+    std::cerr << "Video: " << width << "x" << height << " at " << fps << " fps to " << filename << std::endl;
+}
+
+void VideoSinkPrivate::convert_rgba(const VideoFrame &frame) {
+    size_t pixel_count = size_t(width)*height;
+    output.assign(pixel_count*4, 0);
+    for(size_t i = size_t(frame.band_top)*width; i < pixel_count; i++) {
+        uint32_t pixel = frame.pixels[i];
+        uint32_t a = pixel >> 24;
+        if(a == 0)
+            continue;
+        uint32_t scale = reciprocal[a];
+        uint8_t *out = &output[i*4];
+        out[0] = uint8_t(std::min(((pixel >> 16 & 0xff)*scale + 32768) >> 16, 255u));
+        out[1] = uint8_t(std::min(((pixel >> 8 & 0xff)*scale + 32768) >> 16, 255u));
+        out[2] = uint8_t(std::min(((pixel & 0xff)*scale + 32768) >> 16, 255u));
+        out[3] = uint8_t(a);
+    }
+}
+
+void VideoSinkPrivate::convert_y4m(const VideoFrame &frame) {
+    static const char frame_header[] = "FRAME\n";
+    size_t pixel_count = size_t(width)*height;
+    size_t header_size = sizeof frame_header - 1;
+    output.resize(header_size + pixel_count*4);
+    std::memcpy(output.data(), frame_header, header_size);
+    uint8_t *plane_y = &output[header_size];
+    uint8_t *plane_u = plane_y + pixel_count;
+    uint8_t *plane_v = plane_u + pixel_count;
+    uint8_t *plane_a = plane_v + pixel_count;
+    /* Transparent black above the band */
+    size_t band_start = size_t(frame.band_top)*width;
+    std::fill(plane_y, plane_y + band_start, 16);
+    std::fill(plane_u, plane_u + band_start, 128);
+    std::fill(plane_v, plane_v + band_start, 128);
+    std::fill(plane_a, plane_a + band_start, 0);
+    for(size_t i = band_start; i < pixel_count; i++) {
+        uint32_t pixel = frame.pixels[i];
+        uint32_t a = pixel >> 24;
+        uint32_t scale = reciprocal[a];
+        int32_t r = int32_t(std::min(((pixel >> 16 & 0xff)*scale + 32768) >> 16, 255u));
+        int32_t g = int32_t(std::min(((pixel >> 8 & 0xff)*scale + 32768) >> 16, 255u));
+        int32_t b = int32_t(std::min(((pixel & 0xff)*scale + 32768) >> 16, 255u));
+        plane_y[i] = uint8_t(((66*r + 129*g + 25*b + 128) >> 8) + 16);
+        plane_u[i] = uint8_t(((-38*r - 74*g + 112*b + 128) >> 8) + 128);
+        plane_v[i] = uint8_t(((112*r - 94*g - 18*b + 128) >> 8) + 128);
+        plane_a[i] = uint8_t(a);
+    }
+}
+
+}
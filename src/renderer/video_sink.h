@@ -0,0 +1,53 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+#pragma once
+#include "../utils.h"
+#include <chrono>
+#include <cstdint>
+
+namespace dmhm {
+
+bool is_valid_video_format(const char *name);
+
+/* Records the rendered frames as a raw video stream at a constant frame rate,
+   "rgba" for straight alpha RGBA bytes without any header, or "y4m" for
+   YUV4MPEG2 with an alpha plane (C444alpha, BT.601 limited range).
+   Frames are converted and written on a thread of its own through a bounded
+   queue, so a slow disk or encoder never holds up the presenter */
+class VideoSink {
+
+public:
+
+    VideoSink(const char *filename, const char *format, uint32_t fps, uint32_t queue_frames);
+    ~VideoSink();
+    /* A frame is written once for every frame period that has begun since the
+       previous one, so it may be written several times or not at all */
+    void push_frame(const uint32_t *bitmap, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top, std::chrono::steady_clock::time_point render_time);
+    /* For offline rendering, writes the frame exactly once, waiting for room in the queue.
+       band points to row band_top of the frame, rows above are transparent */
+    void write_frame(const uint32_t *band, uint32_t stride, uint32_t width, uint32_t height, uint32_t band_top);
+    void print_stats(std::chrono::steady_clock::time_point now);
+
+private:
+
+    proxy_ptr<struct VideoSinkPrivate> p;
+
+};
+
+}
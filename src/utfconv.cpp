@@ -88,6 +88,55 @@ std::wstring utf8_to_wide(const std::string &utf8str, bool strict) {
     return widestr;
 }
 
+std::u32string utf8_to_ucs4(const std::string &utf8str, bool strict) {
+    std::u32string ucs4str;
+    size_t i = 0;
+    ucs4str.reserve(utf8str.size());
+    while(i < utf8str.size()) {
+        if(uint8_t(utf8str[i]) < 0x80) {
+            ucs4str.push_back(char32_t(utf8str[i]));
+            ++i;
+            continue;
+        } else if(uint8_t(utf8str[i]) < 0xc0) {
+        } else if(uint8_t(utf8str[i]) < 0xe0) {
+            if(utf8_check_continuation(utf8str, i, 1)) {
+                uint32_t ucs4 = uint32_t(utf8str[i] & 0x1f) << 6 | uint32_t(utf8str[i+1] & 0x3f);
+                if(ucs4 >= 0x80) {
+                    ucs4str.push_back(char32_t(ucs4));
+                    i += 2;
+                    continue;
+                }
+            }
+        } else if(uint8_t(utf8str[i]) < 0xf0) {
+            if(utf8_check_continuation(utf8str, i, 2)) {
+                uint32_t ucs4 = uint32_t(utf8str[i] & 0xf) << 12 | uint32_t(utf8str[i+1] & 0x3f) << 6 | (utf8str[i+2] & 0x3f);
+                if(ucs4 >= 0x800 && (ucs4 & 0xf800) != 0xd800) {
+                    ucs4str.push_back(char32_t(ucs4));
+                    i += 3;
+                    continue;
+                }
+            }
+        } else if(uint8_t(utf8str[i]) < 0xf8) {
+            if(utf8_check_continuation(utf8str, i, 3)) {
+                uint32_t ucs4 = uint32_t(utf8str[i] & 0x7) << 18 | uint32_t(utf8str[i+1] & 0x3f) << 12 | uint32_t(utf8str[i+2] & 0x3f) << 6 | uint32_t(utf8str[i+3] & 0x3f);
+                if(ucs4 >= 0x10000 && ucs4 < 0x110000) {
+                    ucs4str.push_back(char32_t(ucs4));
+                    i += 4;
+                    continue;
+                }
+            }
+        }
+        if(strict)
+            throw unicode_conversion_error();
+        else {
+            ucs4str.push_back(0xfffd);
+            ++i;
+        }
+    }
+    ucs4str.shrink_to_fit();
+    return ucs4str;
+}
+
 std::string wide_to_utf8(const std::wstring &widestr, bool strict) {
     std::string utf8str;
     size_t i = 0;
@@ -160,6 +160,7 @@ public:
 };
 
 std::wstring utf8_to_wide(const std::string &utf8str, bool strict = false);
+std::u32string utf8_to_ucs4(const std::string &utf8str, bool strict = false);
 std::string utf8_validify(const std::string &utf8str, bool strict = false);
 
 }
@@ -0,0 +1,208 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/* Compares the shadow blur engines across shadow_radius values,
+   then the shadow_downsample settings against the full resolution box blur,
+   then the cost of the outline engines against the box blur.
+   Build with `make blur_benchmark`, run as `./blur_benchmark [width height]` */
+
+#include "../src/renderer/blur.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace dmhm;
+
+/* Lines of glyph-sized blobs, similar to what paint_text produces */
+static void fill_text_like(std::vector<uint32_t> &plane, int32_t w, int32_t h) {
+    uint32_t seed = 12345;
+    auto rand = [&]() -> uint32_t {
+        seed = seed*1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+    std::fill(plane.begin(), plane.end(), 0);
+    for(int32_t baseline = 32; baseline < h; baseline += 32)
+        for(int32_t x = 8; x+16 < w; x += 18)
+            for(int32_t i = baseline-20; i < baseline; i++)
+                for(int32_t j = x; j < x+14; j++)
+                    if(rand() % 3 == 0)
+                        plane[size_t(i)*w + j] = 255;
+}
+
+static void gauss_blur_exact(const std::vector<uint32_t> &src, std::vector<double> &dst, int32_t w, int32_t h, double sigma) {
+    int32_t r = int32_t(std::ceil(sigma*4));
+    std::vector<double> kernel(2*r+1);
+    double sum = 0;
+    for(int32_t i = -r; i <= r; i++)
+        sum += kernel[i+r] = std::exp(-0.5*i*i/(sigma*sigma));
+    for(double &i : kernel)
+        i /= sum;
+    std::vector<double> tmp(size_t(w)*h);
+    for(int32_t i = 0; i < h; i++)
+        for(int32_t j = 0; j < w; j++) {
+            double acc = 0;
+            for(int32_t k = -r; k <= r; k++)
+                acc += kernel[k+r]*src[size_t(i)*w + std::min(std::max(j+k, 0), w-1)];
+            tmp[size_t(i)*w + j] = acc;
+        }
+    dst.resize(size_t(w)*h);
+    for(int32_t i = 0; i < h; i++)
+        for(int32_t j = 0; j < w; j++) {
+            double acc = 0;
+            for(int32_t k = -r; k <= r; k++)
+                acc += kernel[k+r]*tmp[size_t(std::min(std::max(i+k, 0), h-1))*w + j];
+            dst[size_t(i)*w + j] = acc;
+        }
+}
+
+static void compare(const std::vector<uint32_t> &result, const std::vector<double> &exact, double &max_error, double &mean_error) {
+    max_error = 0;
+    mean_error = 0;
+    for(size_t i = 0; i < result.size(); i++) {
+        double error = std::fabs(result[i]-exact[i]);
+        max_error = std::max(max_error, error);
+        mean_error += error;
+    }
+    mean_error /= result.size();
+}
+
+/* Difference of two 8-bit planes, PSNR in dB is infinite when they are equal */
+static void image_difference(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b, double &max_error, double &mean_error, double &psnr) {
+    max_error = 0;
+    mean_error = 0;
+    double square_error = 0;
+    for(size_t i = 0; i < a.size(); i++) {
+        double error = std::fabs(double(a[i])-double(b[i]));
+        max_error = std::max(max_error, error);
+        mean_error += error;
+        square_error += error*error;
+    }
+    mean_error /= a.size();
+    square_error /= a.size();
+    psnr = square_error == 0 ? INFINITY : 10*std::log10(255.0*255.0/square_error);
+}
+
+int main(int argc, char *argv[]) {
+    int32_t w = argc > 2 ? std::atoi(argv[1]) : 480;
+    int32_t h = argc > 2 ? std::atoi(argv[2]) : 1440;
+    const int rounds = 20;
+    const double radii[] = {2, 4, 8, 16, 32, 64};
+
+    std::vector<uint32_t> input(size_t(w)*h);
+    fill_text_like(input, w, h);
+    std::vector<uint32_t> scl(input.size()), tcl(input.size());
+    std::vector<float> workspace;
+    std::vector<double> exact;
+
+    std::printf("Stage %dx%d, %d rounds, error against exact Gaussian in 8-bit levels\n", w, h, rounds);
+    std::printf("%6s  %10s %8s %8s  %10s %8s %8s\n", "radius", "box ms", "max err", "avg err", "iir ms", "max err", "avg err");
+    for(double radius : radii) {
+        double sigma = radius/3;
+        uint32_t boxes[blur_box_rounds];
+        compute_blur_boxes(sigma, boxes);
+        gauss_blur_exact(input, exact, w, h, sigma);
+
+        typedef std::chrono::duration<double, std::milli> milliseconds;
+        double max_error[2], mean_error[2];
+        milliseconds elapsed[2] = {milliseconds(0), milliseconds(0)};
+        for(int engine = 0; engine < 2; engine++) {
+            for(int i = 0; i < rounds; i++) {
+                scl = input;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                if(engine == 0)
+                    gauss_blur_box(scl.data(), tcl.data(), w, h, boxes);
+                else
+                    gauss_blur_iir(scl.data(), w, h, sigma, workspace);
+                elapsed[engine] += std::chrono::steady_clock::now()-start;
+            }
+            compare(scl, exact, max_error[engine], mean_error[engine]);
+        }
+        std::printf("%6g  %10.3f %8.2f %8.3f  %10.3f %8.2f %8.3f\n", radius,
+            elapsed[0].count()/rounds, max_error[0], mean_error[0],
+            elapsed[1].count()/rounds, max_error[1], mean_error[1]);
+    }
+
+    const uint32_t factors[] = {2, 4};
+    std::vector<uint32_t> argb(input.size());
+    for(size_t i = 0; i < input.size(); i++)
+        argb[i] = input[i] << 24;
+    std::vector<uint32_t> reference(input.size()), upsampled(input.size());
+
+    std::printf("\nshadow_downsample against full resolution box blur, difference in 8-bit levels\n");
+    std::printf("%6s %6s  %10s %10s %8s %8s %8s\n", "radius", "factor", "full ms", "reduced ms", "max err", "avg err", "PSNR dB");
+    for(double radius : radii) {
+        typedef std::chrono::duration<double, std::milli> milliseconds;
+        uint32_t boxes[blur_box_rounds];
+        compute_blur_boxes(radius/3, boxes);
+        milliseconds full_elapsed(0);
+        for(int i = 0; i < rounds; i++) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for(size_t j = 0; j < argb.size(); j++)
+                reference[j] = argb[j] >> 24;
+            gauss_blur_box(reference.data(), tcl.data(), w, h, boxes);
+            full_elapsed += std::chrono::steady_clock::now()-start;
+        }
+        for(uint32_t factor : factors) {
+            int32_t small_w = int32_t((w + factor-1) / factor);
+            int32_t small_h = int32_t((h + factor-1) / factor);
+            std::vector<uint32_t> small(size_t(small_w)*small_h), small_tcl(small.size());
+            compute_blur_boxes(radius/3/factor, boxes);
+            milliseconds elapsed(0);
+            for(int i = 0; i < rounds; i++) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                downsample_alpha(argb.data(), uint32_t(w), w, h, small.data(), uint32_t(small_w), factor);
+                gauss_blur_box(small.data(), small_tcl.data(), small_w, small_h, boxes);
+                upsample_bilinear(small.data(), uint32_t(small_w), small_w, small_h, upsampled.data(), uint32_t(w), w, h, factor);
+                elapsed += std::chrono::steady_clock::now()-start;
+            }
+            double max_error, mean_error, psnr;
+            image_difference(upsampled, reference, max_error, mean_error, psnr);
+            std::printf("%6g %6u  %10.3f %10.3f %8.2f %8.3f %8.2f\n", radius, factor,
+                full_elapsed.count()/rounds, elapsed.count()/rounds, max_error, mean_error, psnr);
+        }
+    }
+
+    std::printf("\noutline engines against box blur\n");
+    std::printf("%6s %6s  %10s %10s %10s\n", "radius", "width", "box ms", "hard ms", "soft ms");
+    std::vector<uint32_t> outline_workspace;
+    for(double radius : radii) {
+        typedef std::chrono::duration<double, std::milli> milliseconds;
+        uint32_t boxes[blur_box_rounds];
+        compute_blur_boxes(radius/3, boxes);
+        uint32_t outline_radius = compute_outline_radius(radius/3);
+        milliseconds elapsed[3] = {milliseconds(0), milliseconds(0), milliseconds(0)};
+        for(int engine = 0; engine < 3; engine++)
+            for(int i = 0; i < rounds; i++) {
+                scl = input;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                if(engine == 0)
+                    gauss_blur_box(scl.data(), tcl.data(), w, h, boxes);
+                else
+                    outline_alpha(scl.data(), tcl.data(), w, h, outline_radius, engine == 2, outline_workspace);
+                elapsed[engine] += std::chrono::steady_clock::now()-start;
+            }
+        std::printf("%6g %6u  %10.3f %10.3f %10.3f\n", radius, outline_radius,
+            elapsed[0].count()/rounds, elapsed[1].count()/rounds, elapsed[2].count()/rounds);
+    }
+    return 0;
+}
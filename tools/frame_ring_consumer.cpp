@@ -0,0 +1,251 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+/* Reference consumer for the shared memory frame ring, see
+   src/renderer/frame_ring_format.h. Follows the frames of a running
+   live_danmaku_hime and reports every second how late they arrive.
+   With --self-test, publishes synthetic frames from a thread of its own
+   instead, as a latency test of the ring without a renderer.
+   Build with `make frame_ring_consumer`, run as
+   `./frame_ring_consumer /live_danmaku_hime [seconds] [last_frame.pam]` or
+   `./frame_ring_consumer --self-test [fps] [seconds]` */
+
+#include "../src/renderer/frame_ring.h"
+#include "../src/renderer/frame_ring_format.h"
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec)*1000000000 + uint64_t(now.tv_nsec);
+}
+
+struct Ring {
+    uint8_t *mapping = nullptr;
+    size_t size = 0;
+    dmhm_frame_ring_header *header = nullptr;
+
+    bool open(const char *name) {
+        int fd = shm_open(name, O_RDWR, 0);
+        if(fd == -1)
+            return false;
+        struct stat ring_stat;
+        void *data = MAP_FAILED;
+        if(fstat(fd, &ring_stat) == 0 && size_t(ring_stat.st_size) >= sizeof (dmhm_frame_ring_header))
+            data = mmap(nullptr, size_t(ring_stat.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(data == MAP_FAILED)
+            return false;
+        mapping = reinterpret_cast<uint8_t *>(data);
+        size = size_t(ring_stat.st_size);
+        header = reinterpret_cast<dmhm_frame_ring_header *>(mapping);
+        /* The writer fills in the magic last */
+        if(__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != DMHM_FRAME_RING_MAGIC || header->version != DMHM_FRAME_RING_VERSION ||
+            header->slot_offset + header->slot_size*header->slot_count > size) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    void close() {
+        if(mapping)
+            munmap(mapping, size);
+        mapping = nullptr;
+        header = nullptr;
+    }
+    const dmhm_frame_slot *get_slot(uint64_t sequence) const {
+        return reinterpret_cast<const dmhm_frame_slot *>(mapping + header->slot_offset + header->slot_size*(sequence % header->slot_count));
+    }
+    /* Sleeps until the futex word is no longer old_value, or a timeout */
+    void wait(uint32_t old_value, uint32_t timeout_ms) {
+        struct timespec timeout = { time_t(timeout_ms/1000), long(timeout_ms%1000)*1000000 };
+        __atomic_add_fetch(&header->waiters, 1, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, &header->latest, FUTEX_WAIT, old_value, &timeout, nullptr, 0);
+        __atomic_sub_fetch(&header->waiters, 1, __ATOMIC_SEQ_CST);
+    }
+};
+
+struct Stats {
+    uint64_t frames = 0, repeated = 0, missed = 0, torn = 0;
+    uint64_t render_total = 0, render_max = 0;
+    uint64_t wake_total = 0, wake_max = 0;
+    void add(const dmhm_frame_slot &slot, uint64_t received) {
+        frames++;
+        if(slot.dirty_height == 0)
+            repeated++;
+        uint64_t render = received - slot.render_ns, wake = received - slot.publish_ns;
+        render_total += render; render_max = std::max(render_max, render);
+        wake_total += wake; wake_max = std::max(wake_max, wake);
+    }
+    void print(const char *label) const {
+        std::printf("%s: %llu frames (%llu repeated), %llu missed, %llu torn, "
+            "render to receive %.3f ms average %.3f ms max, publish to receive %.3f ms average %.3f ms max\n",
+            label, (unsigned long long) frames, (unsigned long long) repeated, (unsigned long long) missed, (unsigned long long) torn,
+            frames ? render_total/1e6/frames : 0.0, render_max/1e6, frames ? wake_total/1e6/frames : 0.0, wake_max/1e6);
+        std::fflush(stdout);
+    }
+};
+
+/* Premultiplied ARGB to straight RGBA, so the alpha can be checked in an image viewer */
+static void dump_pam(const char *filename, const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t stride) {
+    FILE *file = std::fopen(filename, "wb");
+    if(!file) {
+        std::perror(filename);
+        return;
+    }
+    std::fprintf(file, "P7\nWIDTH %u\nHEIGHT %u\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+    std::vector<uint8_t> row(size_t(width)*4);
+    for(uint32_t y = 0; y < height; y++) {
+        const uint32_t *src = reinterpret_cast<const uint32_t *>(pixels + size_t(y)*stride);
+        for(uint32_t x = 0; x < width; x++) {
+            uint32_t a = src[x] >> 24;
+            for(int c = 0; c < 3; c++)
+                row[x*4+c] = a ? uint8_t(std::min((((src[x] >> (16-c*8)) & 0xff)*255 + a/2) / a, 255u)) : 0;
+            row[x*4+3] = uint8_t(a);
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    std::fclose(file);
+}
+
+/* Follows the ring until the deadline, returns the totals */
+static Stats consume(const char *name, uint64_t duration_ns, const char *dump_filename) {
+    Stats total, second;
+    Ring ring;
+    uint64_t deadline = monotonic_ns() + duration_ns;
+    uint64_t checkpoint = monotonic_ns();
+    uint64_t last_sequence = 0;
+    std::vector<uint8_t> last_frame, last_good_frame;
+    uint32_t width = 0, height = 0, stride = 0;
+    while(monotonic_ns() < deadline) {
+        if(!ring.header) {
+            if(!ring.open(name)) {
+                usleep(100000);
+                continue;
+            }
+            std::printf("Opened %s, %u slots of %ux%u\n", name, ring.header->slot_count, ring.header->width, ring.header->height);
+            last_sequence = __atomic_load_n(&ring.header->latest_sequence, __ATOMIC_ACQUIRE);
+        }
+        uint32_t futex_value = __atomic_load_n(&ring.header->latest, __ATOMIC_SEQ_CST);
+        uint64_t latest = __atomic_load_n(&ring.header->latest_sequence, __ATOMIC_ACQUIRE);
+        if(latest == last_sequence) {
+            if(!__atomic_load_n(&ring.header->writer_alive, __ATOMIC_SEQ_CST)) {
+                std::printf("Writer has gone, reopening\n");
+                ring.close();
+                /* Give it time to unlink the old ring */
+                usleep(100000);
+                continue;
+            }
+            ring.wait(futex_value, 100);
+        } else {
+            /* Catch up with the newest frame if we fell behind */
+            if(latest - last_sequence > 1)
+                second.missed += latest - last_sequence - 1;
+            const dmhm_frame_slot *slot = ring.get_slot(latest);
+            uint64_t received = monotonic_ns();
+            dmhm_frame_slot slot_header = *slot;
+            /* A real consumer would upload the pixels here, straight from the slot */
+            if(dump_filename) {
+                const uint8_t *pixels = reinterpret_cast<const uint8_t *>(slot) + DMHM_FRAME_SLOT_HEADER_SIZE;
+                last_frame.assign(pixels, pixels + size_t(ring.header->stride)*ring.header->height);
+            }
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != latest || slot_header.sequence != latest)
+                second.torn++;
+            else {
+                second.add(slot_header, received);
+                if(dump_filename) {
+                    last_good_frame.swap(last_frame);
+                    width = ring.header->width;
+                    height = ring.header->height;
+                    stride = ring.header->stride;
+                }
+            }
+            last_sequence = latest;
+        }
+        if(monotonic_ns() - checkpoint >= 1000000000) {
+            second.print("Last second");
+            total.frames += second.frames; total.repeated += second.repeated; total.missed += second.missed; total.torn += second.torn;
+            total.render_total += second.render_total; total.render_max = std::max(total.render_max, second.render_max);
+            total.wake_total += second.wake_total; total.wake_max = std::max(total.wake_max, second.wake_max);
+            second = Stats();
+            checkpoint = monotonic_ns();
+        }
+    }
+    ring.close();
+    if(dump_filename && !last_good_frame.empty())
+        dump_pam(dump_filename, last_good_frame.data(), width, height, stride);
+    return total;
+}
+
+static int self_test(uint32_t fps, uint32_t seconds) {
+    const char name[] = "/dmhm_frame_ring_self_test";
+    const uint32_t width = 480, height = 1080;
+    std::atomic<bool> stopping(false);
+    std::thread producer([&]() {
+        dmhm::FrameRing ring(name, 3);
+        std::vector<uint32_t> bitmap(size_t(width)*height);
+        std::chrono::steady_clock::time_point next_frame = std::chrono::steady_clock::now();
+        for(uint32_t frame = 0; !stopping; frame++) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            /* A band that grows and shrinks, with a moving pattern in it */
+            uint32_t band_top = height - (frame*7 % height);
+            for(uint32_t y = band_top; y < height; y++)
+                std::fill(&bitmap[size_t(y)*width], &bitmap[size_t(y)*width+width], ((y+frame) & 0xff) * 0x01010101u);
+            ring.publish(bitmap.data(), width, width, height, band_top, frame % 4 == 3, now);
+            next_frame += std::chrono::microseconds(1000000/fps);
+            std::this_thread::sleep_until(next_frame);
+        }
+    });
+    Stats total = consume(name, uint64_t(seconds)*1000000000, nullptr);
+    stopping = true;
+    producer.join();
+    total.print("Total");
+    /* Allow the first frame to be missed, the consumer may open the ring after it */
+    return total.frames == 0 || total.missed > 1 || total.torn != 0 ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::fprintf(stderr, "Usage: %s /shm_name [seconds] [last_frame.pam]\n       %s --self-test [fps] [seconds]\n", argv[0], argv[0]);
+        return 2;
+    }
+    if(std::strcmp(argv[1], "--self-test") == 0)
+        return self_test(argc > 2 ? uint32_t(std::atoi(argv[2])) : 60, argc > 3 ? uint32_t(std::atoi(argv[3])) : 5);
+    uint64_t duration = argc > 2 ? uint64_t(std::atof(argv[2])*1e9) : UINT64_MAX/2;
+    Stats total = consume(argv[1], duration, argc > 3 ? argv[3] : nullptr);
+    total.print("Total");
+    return 0;
+}
@@ -0,0 +1,541 @@
+/*
+  Copyright (c) 2026 StarBrilliant <m13253@hotmail.com>
+  All rights reserved.
+
+  Redistribution and use in source and binary forms are permitted
+  provided that the above copyright notice and this paragraph are
+  duplicated in all such forms and that any documentation,
+  advertising materials, and other materials related to such
+  distribution and use acknowledge that the software was developed by
+  StarBrilliant.
+  The name of StarBrilliant may not be used to endorse or promote
+  products derived from this software without specific prior written
+  permission.
+
+  THIS SOFTWARE IS PROVIDED ``AS IS'' AND WITHOUT ANY EXPRESS OR
+  IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+*/
+
+/* Renders scripted scenarios headlessly at fixed times and compares them against golden images,
+   so a faster path can be shown to paint the same pixels as the plain one.
+   Every kernel (shadow engine and shadow_downsample) has its own goldens, written from the
+   plain path: the whole stage at once, one thread, a fresh renderer for every frame.
+   Each faster path of that kernel (tiles, threads, the frame buffer, frames painted in a row
+   so scrolling reuses the last one) must then match them within the tolerance.
+   Build with `make golden_render`, record goldens with a build that is known to be good by
+   `./golden_render --update golden_dir font.ttf [fallback fonts]`, check later builds with
+   `./golden_render [--tolerance n] [--diffs dir] golden_dir font.ttf [fallback fonts]`.
+   Goldens depend on the fonts and on the defaults in config.cpp, the configuration file is not read.
+   Images are PAM files of premultiplied RGBA, a mismatch leaves the frame and a diff image in
+   the diffs directory, red where the difference is over the tolerance and blue where within.
+   With --signatures the goldens are one text file instead, small enough to be checked in and
+   run by ctest: each plain frame is kept as a hash and the mean of every 32x32 cell in 1/16
+   steps, a frame that does not hash the same must have its cells within --cell-tolerance
+   sixteenths of a level (to allow for rounding in another cairo), the faster paths
+   are then compared pixel by pixel against the plain frames painted in the same run.
+   ctest checks tools/golden_signatures.txt with TEST_FONT_FILE, record it again with
+   `./golden_render --signatures --update ../tools/golden_signatures.txt font.ttf` when the
+   rendering is changed on purpose */
+
+#include "../src/utils.h"
+#include "../src/config.h"
+#include "../src/renderer/blur.h"
+#include "../src/renderer/cairo_render.h"
+#include "../src/renderer/danmaku_entry.h"
+#include "../src/renderer/font_chain.h"
+#include "../src/renderer/prerasterizer.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace dmhm;
+
+static const uint32_t stage_height = 480;
+/* The rate frames are painted at in a row */
+static const uint32_t sequence_fps = 30;
+/* Side of the square cells a signature averages */
+static const uint32_t signature_cell = 32;
+/* Cell means are kept in 1/16 steps of a level */
+static const uint32_t signature_scale = 16;
+
+struct Scenario {
+    const char *name;
+    std::vector<std::pair<double, std::string>> lines;
+    std::vector<double> times;
+};
+
+struct Kernel {
+    const char *shadow_engine;
+    uint32_t shadow_downsample;
+};
+
+struct Variant {
+    const char *name;
+    uint32_t tile_cache_size;
+    uint32_t render_threads;
+    bool frame_buffer;
+    bool sequence;
+};
+
+static const Kernel kernels[] = {
+    {"box", 1},
+    {"box", 2},
+    {"box", 4},
+    {"iir", 1},
+    {"iir", 2},
+    {"stamp", 1},
+    {"outline", 1},
+    {"soft_outline", 1},
+};
+
+/* The first one writes the goldens */
+static const Variant variants[] = {
+    {"stage", 0, 1, false, false},
+    {"tiles", 256, 1, false, false},
+    {"small_tiles", 4, 1, false, false},
+    {"threads", 0, 4, false, false},
+    {"tiles_threads", 256, 4, false, false},
+    {"frame_buffer", 256, 1, true, false},
+    {"sequence", 0, 1, false, true},
+    {"tiles_sequence", 256, 1, false, true},
+    {"frame_buffer_sequence", 256, 4, true, true},
+};
+
+static std::vector<Scenario> make_scenarios() {
+    std::vector<Scenario> scenarios;
+    double lifetime = config::danmaku_lifetime;
+    double attack = config::danmaku_attack;
+    double decay = config::danmaku_decay;
+
+    /* One line through attack, rest and decay */
+    Scenario single = {"single", {{0, "Hello, world! gjpqy"}}, {0, attack/2, attack, lifetime/2, lifetime-decay/2, lifetime+0.1}};
+    scenarios.push_back(single);
+
+    /* More lines at once than the stage holds */
+    Scenario burst = {"burst", {}, {0.05, attack/3, attack+0.1, 3}};
+    for(int i = 0; i < 60; i++)
+        burst.lines.push_back(std::make_pair(0.0, "Burst line "+std::to_string(i)+std::string(size_t(i%7), '!')));
+    scenarios.push_back(burst);
+
+    /* A steady stream, so lines keep scrolling and expiring */
+    Scenario steady = {"steady", {}, {2, 5.5, 10.01, 15.5, 20.2}};
+    for(int i = 0; i < 55; i++)
+        steady.lines.push_back(std::make_pair(i*0.37, "Message "+std::to_string(i)+" "+std::string(size_t(i*7%23), 'x')));
+    scenarios.push_back(steady);
+
+    /* Wrapping, fallback glyphs and odd characters */
+    Scenario mixed = {"mixed", {
+        {0, "A long line that has to wrap around the edge of the stage, more than once if the stage is narrow enough to need it"},
+        // Hello, Chinese and Japanese
+        {0.2, "\xe4\xbd\xa0\xe5\xa5\xbd\xef\xbc\x8c\xe4\xb8\x96\xe7\x95\x8c \xe3\x81\x93\xe3\x82\x93\xe3\x81\xab\xe3\x81\xa1\xe3\x81\xaf"},
+        {0.2, "Tab\there, emoji \xf0\x9f\x98\x80 and combining e\xcc\x81"},
+        {1, " "},
+        {1.5, "WWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWWW"},
+    }, {0.3, 1, 1.7, 6}};
+    scenarios.push_back(mixed);
+    return scenarios;
+}
+
+static std::chrono::steady_clock::time_point to_time_point(double seconds) {
+    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+static std::vector<PreparedDanmaku> prepare_timeline(const Scenario &scenario, FontChain &font_chain) {
+    std::vector<PreparedDanmaku> timeline;
+    timeline.reserve(scenario.lines.size());
+    for(const std::pair<double, std::string> &i : scenario.lines) {
+        timeline.push_back(PreparedDanmaku(DanmakuEntry(i.second, to_time_point(i.first))));
+        font_chain.layout_text(timeline.back().entry.message, timeline.back().glyph_run);
+    }
+    return timeline;
+}
+
+/* A whole stage of premultiplied ARGB, rows above the band are transparent */
+typedef std::vector<uint32_t> Image;
+
+static void capture(Image &image, uint32_t width, const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+    image.assign(size_t(width)*stage_height, 0);
+    for(uint32_t i = band_top; i < band_top+band_height; i++)
+        std::memcpy(&image[size_t(i)*width], bitmap + size_t(i)*stride, width*sizeof (uint32_t));
+}
+
+/* Frames of one variant at every time of the scenario */
+static std::vector<Image> render_variant(const std::vector<PreparedDanmaku> &timeline, const std::vector<double> &times, const Variant &variant, uint32_t width) {
+    std::vector<Image> images(times.size());
+    std::vector<uint32_t> frame_buffer;
+    uint32_t frame_buffer_stride = width+16;
+    if(variant.frame_buffer)
+        frame_buffer.resize(size_t(frame_buffer_stride)*stage_height);
+    config::tile_cache_size = variant.tile_cache_size;
+
+    if(variant.sequence) {
+        CairoRenderer renderer(timeline, variant.render_threads);
+        if(variant.frame_buffer)
+            renderer.set_frame_buffer(frame_buffer.data(), frame_buffer_stride);
+        uint64_t frame = 0;
+        for(size_t i = 0; i < times.size(); i++) {
+            for(; double(frame)/sequence_fps < times[i]; frame++)
+                renderer.paint_frame_at(width, stage_height, to_time_point(double(frame)/sequence_fps), [](const uint32_t *, uint32_t, uint32_t, uint32_t) {});
+            renderer.paint_frame_at(width, stage_height, to_time_point(times[i]), [&](const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+                capture(images[i], width, bitmap, stride, band_top, band_height);
+            });
+        }
+    } else
+        for(size_t i = 0; i < times.size(); i++) {
+            CairoRenderer renderer(timeline, variant.render_threads);
+            if(variant.frame_buffer)
+                renderer.set_frame_buffer(frame_buffer.data(), frame_buffer_stride);
+            renderer.paint_frame_at(width, stage_height, to_time_point(times[i]), [&](const uint32_t *bitmap, uint32_t stride, uint32_t band_top, uint32_t band_height) {
+                capture(images[i], width, bitmap, stride, band_top, band_height);
+            });
+        }
+    return images;
+}
+
+static bool write_pam(const std::string &filename, const uint32_t *pixels, uint32_t width, uint32_t height) {
+    FILE *file = std::fopen(filename.c_str(), "wb");
+    if(!file) {
+        std::perror(filename.c_str());
+        return false;
+    }
+    std::fprintf(file, "P7\nWIDTH %u\nHEIGHT %u\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+    std::vector<uint8_t> row(size_t(width)*4);
+    for(uint32_t y = 0; y < height; y++) {
+        for(uint32_t x = 0; x < width; x++) {
+            uint32_t pixel = pixels[size_t(y)*width+x];
+            row[x*4] = uint8_t(pixel >> 16);
+            row[x*4+1] = uint8_t(pixel >> 8);
+            row[x*4+2] = uint8_t(pixel);
+            row[x*4+3] = uint8_t(pixel >> 24);
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if(!ok)
+        std::fprintf(stderr, "Failed to write %s\n", filename.c_str());
+    return ok;
+}
+
+/* Only what write_pam writes */
+static bool read_pam(const std::string &filename, Image &image, uint32_t width, uint32_t height) {
+    FILE *file = std::fopen(filename.c_str(), "rb");
+    if(!file)
+        return false;
+    unsigned int file_width = 0, file_height = 0;
+    bool ok = std::fscanf(file, "P7 WIDTH %u HEIGHT %u DEPTH 4 MAXVAL 255 TUPLTYPE RGB_ALPHA ENDHDR", &file_width, &file_height) == 2 && std::fgetc(file) == '\n';
+    if(ok && (file_width != width || file_height != height)) {
+        std::fprintf(stderr, "%s is %ux%u instead of %ux%u\n", filename.c_str(), file_width, file_height, width, height);
+        ok = false;
+    }
+    std::vector<uint8_t> data(size_t(width)*height*4);
+    ok = ok && std::fread(data.data(), 1, data.size(), file) == data.size();
+    std::fclose(file);
+    if(!ok)
+        return false;
+    image.resize(size_t(width)*height);
+    for(size_t i = 0; i < image.size(); i++)
+        image[i] = uint32_t(data[i*4+3]) << 24 | uint32_t(data[i*4]) << 16 | uint32_t(data[i*4+1]) << 8 | data[i*4+2];
+    return true;
+}
+
+/* A plain frame as --signatures keeps it */
+struct Signature {
+    uint64_t hash = 0;
+    uint32_t cells_x = 0;
+    uint32_t cells_y = 0;
+    /* Mean premultiplied ARGB of each cell times signature_scale, 16 bits a channel, row by row */
+    std::vector<uint64_t> cells;
+};
+
+static Signature make_signature(const Image &image, uint32_t width, uint32_t height) {
+    Signature signature;
+    /* FNV-1a over the pixels, byte by byte from the lowest */
+    signature.hash = 0xcbf29ce484222325u;
+    for(uint32_t pixel : image)
+        for(int shift = 0; shift < 32; shift += 8) {
+            signature.hash ^= (pixel >> shift) & 0xff;
+            signature.hash *= 0x100000001b3u;
+        }
+    signature.cells_x = (width+signature_cell-1)/signature_cell;
+    signature.cells_y = (height+signature_cell-1)/signature_cell;
+    signature.cells.reserve(size_t(signature.cells_x)*signature.cells_y);
+    for(uint32_t cell_y = 0; cell_y < signature.cells_y; cell_y++)
+        for(uint32_t cell_x = 0; cell_x < signature.cells_x; cell_x++) {
+            uint32_t left = cell_x*signature_cell, right = std::min(left+signature_cell, width);
+            uint32_t top = cell_y*signature_cell, bottom = std::min(top+signature_cell, height);
+            uint64_t sums[4] = {0, 0, 0, 0};
+            for(uint32_t y = top; y < bottom; y++)
+                for(uint32_t x = left; x < right; x++)
+                    for(int channel = 0; channel < 4; channel++)
+                        sums[channel] += (image[size_t(y)*width+x] >> (channel*8)) & 0xff;
+            uint64_t count = uint64_t(right-left)*(bottom-top);
+            uint64_t mean = 0;
+            for(int channel = 0; channel < 4; channel++)
+                mean |= (sums[channel]*signature_scale*2+count)/(count*2) << (channel*16);
+            signature.cells.push_back(mean);
+        }
+    return signature;
+}
+
+/* One line a frame: name, hash, cells across and down, then every cell, "-" for a clear one */
+static bool write_signatures(const std::string &filename, const std::vector<std::pair<std::string, Signature>> &signatures, const char *font_file) {
+    FILE *file = std::fopen(filename.c_str(), "w");
+    if(!file) {
+        std::perror(filename.c_str());
+        return false;
+    }
+    std::fprintf(file, "# Written by golden_render --signatures --update from %s, see tools/golden_render.cpp\n", font_file);
+    for(const std::pair<std::string, Signature> &i : signatures) {
+        std::fprintf(file, "%s %016llx %u %u", i.first.c_str(), (unsigned long long) i.second.hash, i.second.cells_x, i.second.cells_y);
+        for(uint64_t cell : i.second.cells)
+            if(cell == 0)
+                std::fputs(" -", file);
+            else
+                std::fprintf(file, " %012llx", (unsigned long long) cell);
+        std::fputc('\n', file);
+    }
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if(!ok)
+        std::fprintf(stderr, "Failed to write %s\n", filename.c_str());
+    return ok;
+}
+
+static bool read_signatures(const std::string &filename, std::map<std::string, Signature> &signatures) {
+    FILE *file = std::fopen(filename.c_str(), "r");
+    if(!file) {
+        std::perror(filename.c_str());
+        return false;
+    }
+    bool ok = true;
+    char name[256];
+    int c;
+    while(ok && (c = std::fgetc(file)) != EOF) {
+        if(c == '#') {
+            while((c = std::fgetc(file)) != EOF && c != '\n') {
+            }
+            continue;
+        }
+        std::ungetc(c, file);
+        Signature signature;
+        unsigned long long hash;
+        if(std::fscanf(file, "%255s %llx %u %u", name, &hash, &signature.cells_x, &signature.cells_y) != 4) {
+            ok = false;
+            break;
+        }
+        signature.hash = uint64_t(hash);
+        signature.cells.resize(size_t(signature.cells_x)*signature.cells_y);
+        for(uint64_t &cell : signature.cells) {
+            char token[24];
+            if(std::fscanf(file, "%23s", token) != 1) {
+                ok = false;
+                break;
+            }
+            cell = std::strcmp(token, "-") == 0 ? 0 : uint64_t(std::strtoull(token, nullptr, 16));
+        }
+        std::fscanf(file, " ");
+        signatures[name] = signature;
+    }
+    std::fclose(file);
+    if(!ok)
+        std::fprintf(stderr, "%s is not a signature file\n", filename.c_str());
+    return ok;
+}
+
+struct Comparison {
+    uint32_t max_difference = 0;
+    uint64_t pixels_over = 0;
+    uint64_t pixels_within = 0;
+};
+
+static uint32_t pixel_difference(uint32_t a, uint32_t b) {
+    uint32_t difference = 0;
+    for(int shift = 0; shift < 32; shift += 8)
+        difference = std::max(difference, uint32_t(std::abs(int32_t((a >> shift) & 0xff) - int32_t((b >> shift) & 0xff))));
+    return difference;
+}
+
+/* Largest difference of a channel of a cell in sixteenths, or UINT32_MAX if the cells do not line up */
+static uint32_t signature_difference(const Signature &golden, const Signature &signature) {
+    if(golden.cells_x != signature.cells_x || golden.cells_y != signature.cells_y)
+        return UINT32_MAX;
+    uint32_t difference = 0;
+    for(size_t i = 0; i < golden.cells.size(); i++)
+        for(int shift = 0; shift < 64; shift += 16)
+            difference = std::max(difference, uint32_t(std::abs(int32_t((golden.cells[i] >> shift) & 0xffff) - int32_t((signature.cells[i] >> shift) & 0xffff))));
+    return difference;
+}
+
+static Comparison compare(const Image &golden, const Image &image, uint32_t tolerance) {
+    Comparison result;
+    for(size_t i = 0; i < golden.size(); i++) {
+        uint32_t difference = pixel_difference(golden[i], image[i]);
+        result.max_difference = std::max(result.max_difference, difference);
+        if(difference > tolerance)
+            result.pixels_over++;
+        else if(difference != 0)
+            result.pixels_within++;
+    }
+    return result;
+}
+
+/* The golden faintly in grey, red over the tolerance, blue within */
+static Image make_diff_image(const Image &golden, const Image &image, uint32_t tolerance) {
+    Image diff(golden.size());
+    for(size_t i = 0; i < golden.size(); i++) {
+        uint32_t difference = pixel_difference(golden[i], image[i]);
+        if(difference > tolerance)
+            diff[i] = 0xffff0000;
+        else if(difference != 0)
+            diff[i] = 0xff0000ff;
+        else {
+            uint32_t grey = (golden[i] >> 24)/4;
+            diff[i] = 0xff000000 | grey << 16 | grey << 8 | grey;
+        }
+    }
+    return diff;
+}
+
+int main(int argc, char *argv[]) {
+    bool update = false;
+    bool use_signatures = false;
+    uint32_t tolerance = 0;
+    uint32_t cell_tolerance = 8;
+    std::string diff_dir = ".";
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-'; arg++)
+        if(std::strcmp(argv[arg], "--update") == 0)
+            update = true;
+        else if(std::strcmp(argv[arg], "--signatures") == 0)
+            use_signatures = true;
+        else if(std::strcmp(argv[arg], "--cell-tolerance") == 0 && arg+1 < argc)
+            cell_tolerance = uint32_t(std::strtoul(argv[++arg], nullptr, 10));
+        else if(std::strcmp(argv[arg], "--tolerance") == 0 && arg+1 < argc)
+            tolerance = uint32_t(std::strtoul(argv[++arg], nullptr, 10));
+        else if(std::strcmp(argv[arg], "--diffs") == 0 && arg+1 < argc)
+            diff_dir = argv[++arg];
+        else
+            break;
+    if(argc-arg < 2) {
+        std::fprintf(stderr, "Usage: %s [--update] [--tolerance n] [--diffs dir] golden_dir font_file [fallback_font_file ...]\n"
+            "       %s --signatures [--update] [--tolerance n] [--cell-tolerance n] [--diffs dir] signature_file font_file [fallback_font_file ...]\n", argv[0], argv[0]);
+        return 2;
+    }
+    /* A directory, or a file with --signatures */
+    std::string golden_dir = argv[arg];
+    std::map<std::string, Signature> signatures;
+    std::vector<std::pair<std::string, Signature>> new_signatures;
+    if(use_signatures && !update && !read_signatures(golden_dir, signatures))
+        return 2;
+    config::font_file = argv[arg+1];
+    for(int i = arg+2; i < argc; i++)
+        config::fallback_font_files.push_back(argv[i]);
+    config::glyph_cache_file = "";
+
+    FontChain font_chain;
+    FT_Error ft_error = font_chain.open_primary(config::font_file, config::font_file_index);
+    if(ft_error != 0) {
+        std::fprintf(stderr, "Failed to open font file %s (FreeType error %d)\n", config::font_file, int(ft_error));
+        return 2;
+    }
+    for(const std::string &i : config::fallback_font_files)
+        font_chain.add_fallback(i);
+
+    uint32_t width = config::stage_width;
+    uint64_t checked = 0, failed = 0, missing = 0, written = 0;
+    for(const Scenario &scenario : make_scenarios()) {
+        std::vector<PreparedDanmaku> timeline = prepare_timeline(scenario, font_chain);
+        for(const Kernel &kernel : kernels) {
+            config::shadow_engine = kernel.shadow_engine;
+            config::shadow_downsample = kernel.shadow_downsample;
+            /* These use the whole stage with tiles or not */
+            bool untileable = parse_shadow_engine(kernel.shadow_engine) == SHADOW_ENGINE_IIR || kernel.shadow_downsample != 1;
+
+            std::vector<std::string> names;
+            std::vector<Image> goldens(scenario.times.size());
+            for(double time : scenario.times) {
+                char name[256];
+                std::snprintf(name, sizeof name, "%s_%s_d%u_%05u", scenario.name, kernel.shadow_engine, kernel.shadow_downsample, uint32_t(std::lround(time*1000)));
+                names.push_back(name);
+            }
+            for(const Variant &variant : variants) {
+                if(untileable && variant.tile_cache_size != 0)
+                    continue;
+                std::vector<Image> images = render_variant(timeline, scenario.times, variant, width);
+                for(size_t i = 0; i < images.size(); i++) {
+                    std::string golden_file = golden_dir+"/"+names[i]+".pam";
+                    if(&variant == &variants[0] && use_signatures) {
+                        /* The plain frame becomes the golden of the faster paths once it matches its signature */
+                        Signature signature = make_signature(images[i], width, stage_height);
+                        goldens[i] = images[i];
+                        if(update) {
+                            new_signatures.push_back(std::make_pair(names[i], signature));
+                            written++;
+                            continue;
+                        }
+                        std::map<std::string, Signature>::const_iterator golden_signature = signatures.find(names[i]);
+                        if(golden_signature == signatures.end()) {
+                            std::printf("MISSING %s in %s, record it with --update\n", names[i].c_str(), golden_dir.c_str());
+                            missing++;
+                            continue;
+                        }
+                        checked++;
+                        if(golden_signature->second.hash == signature.hash)
+                            continue;
+                        uint32_t difference = signature_difference(golden_signature->second, signature);
+                        if(difference <= cell_tolerance)
+                            continue;
+                        failed++;
+                        std::printf("FAIL %s %s: signature differs, max cell difference %u/16 over tolerance %u/16\n",
+                            names[i].c_str(), variant.name, difference, cell_tolerance);
+                        write_pam(diff_dir+"/"+names[i]+"."+variant.name+".pam", images[i].data(), width, stage_height);
+                        continue;
+                    }
+                    if(&variant == &variants[0]) {
+                        if(update) {
+                            if(!write_pam(golden_file, images[i].data(), width, stage_height))
+                                return 2;
+                            goldens[i] = images[i];
+                            written++;
+                            continue;
+                        }
+                        if(!read_pam(golden_file, goldens[i], width, stage_height)) {
+                            std::printf("MISSING %s, record it with --update\n", golden_file.c_str());
+                            missing++;
+                        }
+                    }
+                    if(goldens[i].empty())
+                        continue;
+                    checked++;
+                    Comparison result = compare(goldens[i], images[i], tolerance);
+                    if(result.pixels_over == 0)
+                        continue;
+                    failed++;
+                    std::printf("FAIL %s %s: %llu pixels over tolerance %u, %llu within, max difference %u\n",
+                        names[i].c_str(), variant.name, (unsigned long long) result.pixels_over, tolerance, (unsigned long long) result.pixels_within, result.max_difference);
+                    std::string prefix = diff_dir+"/"+names[i]+"."+variant.name;
+                    write_pam(prefix+".pam", images[i].data(), width, stage_height);
+                    write_pam(prefix+".diff.pam", make_diff_image(goldens[i], images[i], tolerance).data(), width, stage_height);
+                }
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    if(update && use_signatures && !write_signatures(golden_dir, new_signatures, config::font_file))
+        return 2;
+    if(update)
+        std::printf("%llu goldens written to %s, ", (unsigned long long) written, golden_dir.c_str());
+    std::printf("%llu frames checked, %llu failed, %llu goldens missing\n", (unsigned long long) checked, (unsigned long long) failed, (unsigned long long) missing);
+    return failed != 0 || missing != 0 ? 1 : 0;
+}
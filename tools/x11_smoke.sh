@@ -0,0 +1,66 @@
+#!/bin/sh
+# Shows a few comments with the X11 presenter on a virtual X server and checks that
+# frames reach the server through MIT-SHM, that is, that ShmCompletion events come back.
+# Given a GTK build too, shows the same comments with it and checks that the X11 presenter
+# has the lower average present latency.
+# Run by ctest when built with USE_X11_PRESENTER and xvfb-run is installed, with the GTK
+# build taken from GTK_SMOKE_BINARY if set, or by hand:
+#   tools/x11_smoke.sh ./live_danmaku_hime live_danmaku_hime.conf font.ttf [gtk_build/live_danmaku_hime]
+
+set -e
+binary=$(realpath "$1")
+config=$(realpath "$2")
+font=$(realpath "$3")
+gtk_binary=
+if [ -n "$4" ]; then
+    gtk_binary=$(realpath "$4")
+fi
+work_dir=$(mktemp -d)
+trap 'rm -rf "$work_dir"' EXIT
+
+sed -e "s|^font_file = .*|font_file = \"$font\"|" \
+    -e 's|^glyph_cache_file = .*|glyph_cache_file = ""|' \
+    -e 's|^danmaku_lifetime = .*|danmaku_lifetime = 3|' \
+    -e 's|^danmaku_min_lifetime = .*|danmaku_min_lifetime = 2|' \
+    "$config" > "$work_dir/live_danmaku_hime.conf"
+
+cd "$work_dir"
+
+# run name binary, leaves the log in name.log
+run() {
+    status=0
+    printf 'Hello\nPresent latency smoke test\n' | timeout 60 xvfb-run -a -s '-screen 0 1280x720x24 +extension MIT-SHM' "$2" 2> "$1.log" || status=$?
+    cat "$1.log" >&2
+    if [ "$status" != 0 ]; then
+        echo "x11_smoke: $1 exited with status $status" >&2
+        exit 1
+    fi
+    if ! grep -q 'Present latency: .* [1-9][0-9]* frames presented' "$1.log"; then
+        echo "x11_smoke: $1 presented no frames" >&2
+        exit 1
+    fi
+}
+
+# average name, the average of the last report
+average() {
+    sed -n 's/^Present latency: \([0-9.e+-]*\) ms average.*/\1/p' "$1.log" | tail -n 1
+}
+
+run x11 "$binary"
+if grep -q 'MIT-SHM is not available' x11.log; then
+    echo "x11_smoke: MIT-SHM was not used" >&2
+    exit 1
+fi
+if [ -z "$gtk_binary" ]; then
+    echo "x11_smoke: X11 present latency $(average x11) ms average"
+    exit 0
+fi
+
+run gtk "$gtk_binary"
+x11_average=$(average x11)
+gtk_average=$(average gtk)
+echo "x11_smoke: present latency $x11_average ms average with X11, $gtk_average ms with GTK"
+if ! awk -v x11="$x11_average" -v gtk="$gtk_average" 'BEGIN { exit !(x11 < gtk) }'; then
+    echo "x11_smoke: the X11 presenter is not faster than GTK" >&2
+    exit 1
+fi